@@ -1,7 +1,11 @@
 #!/bin/bash
-start=`date +%s`
+# Times the alignment kernels on the toy data set. The JSON output of
+# different versions can be compared to find regressions.
+# usage: scripts/timing.sh [output json file]
 
-./test_graph -i mass_graph_mods.txt -k -p 0 -j 20 H4.fasta 071210_070610His0Gy070210H4_H061010A_msdeconv.msalign
+output=${1:-bench.json}
 
-end=`date +%s`
-echo "Runnig time: " $((end-start)) " seconds"
+bin/topmg_bench --warmup 2 --iterations 20 --output $output \
+  -i ToyCaseForTesting/var_mods.txt ToyCaseForTesting/sim_ms2.msalign
+
+cat $output
@@ -71,6 +71,18 @@ void Argument::initArguments() {
   arguments_["varPtmNumber"] = "5";
   arguments_["varPtmNumInGap"] = "5";
   arguments_["wholeProteinOnly"] = "true";
+  arguments_["abundSearchMode"] = "GRID";
+  arguments_["abundSearchStep"] = "10";
+  arguments_["abundSearchTolerance"] = "1";
+  arguments_["dpThreadNumber"] = "1";
+  arguments_["proteoGraphCacheSize"] = "512";
+  arguments_["binaryOutput"] = "false";
+  arguments_["alignStats"] = "false";
+  arguments_["pruneMinMatched"] = "0";
+  arguments_["pruneMinCoverage"] = "0";
+  arguments_["pruneSinglePath"] = "false";
+  arguments_["memoryBudget"] = "0";
+  arguments_["toleranceModel"] = "FIXED";
   //arguments_["diagonalInfoFileName"] = "";
     
 }
@@ -125,6 +137,18 @@ void Argument::outputArguments(std::ostream &output, std::map<std::string, std::
   output << std::setw(50) << std::left << "Maximum number of variable PTMs in a graph gap: " << "\t" << arguments["varPtmNumInGap"] << std::endl;
   output << std::setw(50) << std::left << "Maximum number of unexpected modifications: " << "\t" << arguments["ptmNumber"] << std::endl;
   output << std::setw(50) << std::left << "Report only proteoforms from whole proteins: " << "\t" << arguments["wholeProteinOnly"] << std::endl;
+  output << std::setw(50) << std::left << "Abundance search mode: " << "\t" << arguments["abundSearchMode"] << std::endl;
+  output << std::setw(50) << std::left << "Abundance search step: " << "\t" << arguments["abundSearchStep"] << std::endl;
+  output << std::setw(50) << std::left << "Abundance search tolerance: " << "\t" << arguments["abundSearchTolerance"] << std::endl;
+  output << std::setw(50) << std::left << "Alignment thread number per spectrum: " << "\t" << arguments["dpThreadNumber"] << std::endl;
+  output << std::setw(50) << std::left << "Proteoform graph cache size (MB): " << "\t" << arguments["proteoGraphCacheSize"] << std::endl;
+  output << std::setw(50) << std::left << "Binary result output: " << "\t" << arguments["binaryOutput"] << std::endl;
+  output << std::setw(50) << std::left << "Alignment stage statistics: " << "\t" << arguments["alignStats"] << std::endl;
+  output << std::setw(50) << std::left << "Pruning minimum matched peaks: " << "\t" << arguments["pruneMinMatched"] << std::endl;
+  output << std::setw(50) << std::left << "Pruning minimum intensity coverage: " << "\t" << arguments["pruneMinCoverage"] << std::endl;
+  output << std::setw(50) << std::left << "Pruning of single path spectra: " << "\t" << arguments["pruneSinglePath"] << std::endl;
+  output << std::setw(50) << std::left << "Memory budget per thread (MB): " << "\t" << arguments["memoryBudget"] << std::endl;
+  output << std::setw(50) << std::left << "Tolerance model: " << "\t" << arguments["toleranceModel"] << std::endl;
   output << std::setw(50) << std::left << "Executable file directory: " << "\t" << arguments["executiveDir"] << std::endl;
   output << std::setw(50) << std::left << "Start time: " << "\t" << arguments["startTime"] << std::endl;
   if (arguments["endTime"] != "") {
@@ -183,6 +207,18 @@ std::string Argument::outputCsvArguments(std::map<std::string, std::string> argu
   output << "Maximum number of variable PTMs:" << comma << arguments["varPtmNumber"] << std::endl;
   output << "Maximum number of variable PTMs in a graph gap:" << comma << arguments["varPtmNumInGap"] << std::endl;
   output << "Maximum number of unexpected modifications:" << comma << arguments["ptmNumber"] << std::endl;
+  output << "Abundance search mode:" << comma << arguments["abundSearchMode"] << std::endl;
+  output << "Abundance search step:" << comma << arguments["abundSearchStep"] << std::endl;
+  output << "Abundance search tolerance:" << comma << arguments["abundSearchTolerance"] << std::endl;
+  output << "Alignment thread number per spectrum:" << comma << arguments["dpThreadNumber"] << std::endl;
+  output << "Proteoform graph cache size (MB):" << comma << arguments["proteoGraphCacheSize"] << std::endl;
+  output << "Binary result output:" << comma << arguments["binaryOutput"] << std::endl;
+  output << "Alignment stage statistics:" << comma << arguments["alignStats"] << std::endl;
+  output << "Pruning minimum matched peaks:" << comma << arguments["pruneMinMatched"] << std::endl;
+  output << "Pruning minimum intensity coverage:" << comma << arguments["pruneMinCoverage"] << std::endl;
+  output << "Pruning of single path spectra:" << comma << arguments["pruneSinglePath"] << std::endl;
+  output << "Memory budget per thread (MB):" << comma << arguments["memoryBudget"] << std::endl;
+  output << "Tolerance model:" << comma << arguments["toleranceModel"] << std::endl;
   output << "Executable file directory:" << comma << arguments["executiveDir"] << std::endl;
   output << "Start time:" << comma << arguments["startTime"] << std::endl;
   if (arguments["endTime"] != "") {
@@ -223,6 +259,15 @@ bool Argument::parse(int argc, char* argv[]) {
   std::string var_ptm_num = "";
   std::string var_ptm_in_gap = "";
   std::string combined_output_name = "";
+  std::string abund_search_mode = "";
+  std::string abund_search_step = "";
+  std::string abund_search_tole = "";
+  std::string dp_thread_number = "";
+  std::string proteo_graph_cache_size = "";
+  std::string prune_min_matched = "";
+  std::string prune_min_coverage = "";
+  std::string memory_budget = "";
+  std::string tolerance_model = "";
 
   // Define and parse the program options
   try {
@@ -255,6 +300,18 @@ bool Argument::parse(int argc, char* argv[]) {
         ("num-shift,s", po::value<std::string> (&ptm_num), "<0|1|2>. Maximum number of unexpected modifications in a proteoform spectrum-match. Default value: 0.")
         ("whole-protein-only,w", "Report only proteoforms from whole proteins.")
         ("combined-file-name,c", po::value<std::string>(&combined_output_name) , "Specify a file name for the combined spectrum data file and analysis results.")
+        ("abund-search", po::value<std::string>(&abund_search_mode), "<GRID|COARSE|GOLDEN>. Search method for the abundances of the two proteoforms. GRID evaluates every abundance pair, COARSE refines the best pair of a coarse grid, GOLDEN uses a golden-section search over the abundance ratio. Default value: GRID.")
+        ("abund-search-step", po::value<std::string>(&abund_search_step), "<a positive number>. Grid step of the COARSE and GOLDEN abundance searches, in percent of the maximum peak intensity. Default value: 10.")
+        ("abund-search-tolerance", po::value<std::string>(&abund_search_tole), "<a positive number>. The COARSE and GOLDEN abundance searches stop when the search step is smaller than this value. Default value: 1.")
+        ("dp-thread-number", po::value<std::string>(&dp_thread_number), "<a positive integer>. Number of threads used in the alignment of one spectrum. Each of the thread-number spectrum-level threads starts this many threads. Default value: 1.")
+        ("proteo-graph-cache-size", po::value<std::string>(&proteo_graph_cache_size), "<a non-negative integer>. Memory in MB used to keep proteoform graphs for reuse by spectra with the same reference peptide. 0 disables the cache. Default value: 512.")
+        ("binary-output", "Also write the quantification results to results.bin, a binary file with fixed-width records that can be memory mapped.")
+        ("align-stats", "Write the wall clock and CPU time of each alignment stage for each spectrum to align_stats.jsonl, and a summary of all spectra to align_stats_summary.json.")
+        ("prune-min-matched", po::value<std::string>(&prune_min_matched), "<a non-negative integer>. Skip the quantification of a spectrum when its best alignment matches fewer peaks. 0 disables this check. Default value: 0.")
+        ("prune-min-coverage", po::value<std::string>(&prune_min_coverage), "<a number between 0 and 1>. Skip the quantification of a spectrum when the peaks of its alignments cover a smaller fraction of the spectrum intensity. 0 disables this check. Default value: 0.")
+        ("prune-single-path", "Skip the quantification of a spectrum when it has only one alignment path, so that the two proteoforms are the same.")
+        ("memory-budget", po::value<std::string>(&memory_budget), "<a non-negative integer>. Memory in MB for the alignment of one spectrum by one thread. Larger spectra are aligned with a slower low-memory method, and spectra that still do not fit are skipped. 0 means no limit. Default value: 0.")
+        ("tolerance-model", po::value<std::string>(&tolerance_model), "<FIXED|PPM>. Mass window of the spectral peaks in graph alignment. FIXED uses a window of about 0.1 Da for all peaks, PPM computes the window of each peak from the error tolerance and the peak type. Default value: FIXED.")
         ("keep-temp-files,k", "Keep temporary files.");
     
 //("skip-list,l", po::value<std::string>(&skip_list) , "<a text file with its path>. The scans in this file will be skipped.")
@@ -283,6 +340,18 @@ bool Argument::parse(int argc, char* argv[]) {
         ("no-topfd-feature,x", "")
         ("skip-list,l", po::value<std::string>(&skip_list) , "")
         ("combined-file-name,c", po::value<std::string>(&combined_output_name) , "")
+        ("abund-search", po::value<std::string>(&abund_search_mode), "")
+        ("abund-search-step", po::value<std::string>(&abund_search_step), "")
+        ("abund-search-tolerance", po::value<std::string>(&abund_search_tole), "")
+        ("dp-thread-number", po::value<std::string>(&dp_thread_number), "")
+        ("proteo-graph-cache-size", po::value<std::string>(&proteo_graph_cache_size), "")
+        ("binary-output", "")
+        ("align-stats", "")
+        ("prune-min-matched", po::value<std::string>(&prune_min_matched), "")
+        ("prune-min-coverage", po::value<std::string>(&prune_min_coverage), "")
+        ("prune-single-path", "")
+        ("memory-budget", po::value<std::string>(&memory_budget), "")
+        ("tolerance-model", po::value<std::string>(&tolerance_model), "")
         ("proteo-graph-gap,j", po::value<std::string> (&proteo_graph_gap), "")
         ("var-ptm-in-gap,G", po::value<std::string>(&var_ptm_in_gap) , "")
         ("use-asf-diagonal,D", "")
@@ -396,6 +465,16 @@ bool Argument::parse(int argc, char* argv[]) {
       arguments_["keepTempFiles"] = "true";
     }
 
+    if (vm.count("binary-output")) {
+      arguments_["binaryOutput"] = "true";
+    }
+    if (vm.count("align-stats")) {
+      arguments_["alignStats"] = "true";
+    }
+    if (vm.count("prune-single-path")) {
+      arguments_["pruneSinglePath"] = "true";
+    }
+
     if (vm.count("filtering-result-number")) {
       arguments_["filteringResultNumber"] = filtering_result_num;
     }
@@ -440,6 +519,36 @@ bool Argument::parse(int argc, char* argv[]) {
       arguments_["wholeProteinOnly"] = "true";
     }
 
+    if (vm.count("abund-search")) {
+      arguments_["abundSearchMode"] = abund_search_mode;
+    }
+
+    if (vm.count("abund-search-step")) {
+      arguments_["abundSearchStep"] = abund_search_step;
+    }
+
+    if (vm.count("abund-search-tolerance")) {
+      arguments_["abundSearchTolerance"] = abund_search_tole;
+    }
+    if (vm.count("dp-thread-number")) {
+      arguments_["dpThreadNumber"] = dp_thread_number;
+    }
+    if (vm.count("proteo-graph-cache-size")) {
+      arguments_["proteoGraphCacheSize"] = proteo_graph_cache_size;
+    }
+    if (vm.count("prune-min-matched")) {
+      arguments_["pruneMinMatched"] = prune_min_matched;
+    }
+    if (vm.count("prune-min-coverage")) {
+      arguments_["pruneMinCoverage"] = prune_min_coverage;
+    }
+    if (vm.count("memory-budget")) {
+      arguments_["memoryBudget"] = memory_budget;
+    }
+    if (vm.count("tolerance-model")) {
+      arguments_["toleranceModel"] = tolerance_model;
+    }
+
 
   }
   catch(std::exception & e) {
@@ -653,6 +762,115 @@ bool Argument::validateArguments() {
     return false;
   }
 
+  std::string abund_search_mode = arguments_["abundSearchMode"];
+  if (abund_search_mode != "GRID" && abund_search_mode != "COARSE" && abund_search_mode != "GOLDEN") {
+    LOG_ERROR("Abundance search mode " << abund_search_mode << " error! The value should be GRID|COARSE|GOLDEN!");
+    return false;
+  }
+
+  std::string abund_search_step = arguments_["abundSearchStep"];
+  try {
+    double step = std::stod(abund_search_step);
+    if (step <= 0.0) {
+      LOG_ERROR("Abundance search step " << abund_search_step << " error! The value should be positive.");
+      return false;
+    }
+  }
+  catch (std::exception & e) {
+    LOG_ERROR("Abundance search step " << abund_search_step << " should be a number.");
+    return false;
+  }
+
+  std::string abund_search_tole = arguments_["abundSearchTolerance"];
+  try {
+    double tole = std::stod(abund_search_tole);
+    if (tole <= 0.0) {
+      LOG_ERROR("Abundance search tolerance " << abund_search_tole << " error! The value should be positive.");
+      return false;
+    }
+  }
+  catch (std::exception & e) {
+    LOG_ERROR("Abundance search tolerance " << abund_search_tole << " should be a number.");
+    return false;
+  }
+
+  std::string dp_thread_number = arguments_["dpThreadNumber"];
+  try {
+    int num = std::stoi(dp_thread_number);
+    if (num <= 0) {
+      LOG_ERROR("Alignment thread number " << dp_thread_number << " error! The value should be positive.");
+      return false;
+    }
+    int total = num * std::stoi(arguments_["threadNumber"]);
+    int n = static_cast<int>(boost::thread::hardware_concurrency());
+    if (total > n) {
+      LOG_ERROR("Alignment thread number " << dp_thread_number << " error! The product with the thread number is too large. Only " << n << " threads are supported.");
+      return false;
+    }
+  }
+  catch (std::exception & e) {
+    LOG_ERROR("Alignment thread number " << dp_thread_number << " should be a number.");
+    return false;
+  }
+
+  std::string proteo_graph_cache_size = arguments_["proteoGraphCacheSize"];
+  try {
+    int size = std::stoi(proteo_graph_cache_size);
+    if (size < 0) {
+      LOG_ERROR("Proteoform graph cache size " << proteo_graph_cache_size << " error! The value should be non-negative.");
+      return false;
+    }
+  }
+  catch (std::exception & e) {
+    LOG_ERROR("Proteoform graph cache size " << proteo_graph_cache_size << " should be a number.");
+    return false;
+  }
+
+  std::string prune_min_matched = arguments_["pruneMinMatched"];
+  try {
+    int num = std::stoi(prune_min_matched);
+    if (num < 0) {
+      LOG_ERROR("Pruning minimum matched peaks " << prune_min_matched << " error! The value should be non-negative.");
+      return false;
+    }
+  }
+  catch (std::exception & e) {
+    LOG_ERROR("Pruning minimum matched peaks " << prune_min_matched << " should be a number.");
+    return false;
+  }
+
+  std::string prune_min_coverage = arguments_["pruneMinCoverage"];
+  try {
+    double cov = std::stod(prune_min_coverage);
+    if (cov < 0.0 || cov > 1.0) {
+      LOG_ERROR("Pruning minimum intensity coverage " << prune_min_coverage << " error! The value should be between 0 and 1.");
+      return false;
+    }
+  }
+  catch (std::exception & e) {
+    LOG_ERROR("Pruning minimum intensity coverage " << prune_min_coverage << " should be a number.");
+    return false;
+  }
+
+  std::string memory_budget = arguments_["memoryBudget"];
+  try {
+    int size = std::stoi(memory_budget);
+    if (size < 0) {
+      LOG_ERROR("Memory budget " << memory_budget << " error! The value should be non-negative.");
+      return false;
+    }
+  }
+  catch (std::exception & e) {
+    LOG_ERROR("Memory budget " << memory_budget << " should be a number.");
+    return false;
+  }
+
+  std::string tolerance_model = arguments_["toleranceModel"];
+  if (tolerance_model != "FIXED" && tolerance_model != "PPM") {
+    LOG_ERROR("Tolerance model " << tolerance_model << " error! The value should be FIXED|PPM!");
+    return false;
+  }
+
   return true;
 }
 } /* namespace toppic */
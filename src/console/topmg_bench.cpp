@@ -0,0 +1,464 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+// Microbenchmarks of the graph alignment kernels.
+//
+// Usage: topmg_bench [--warmup N] [--iterations N] [--output FILE] [topmg options]
+//
+// The remaining options are parsed as topmg options. Without them the toy
+// data set is used, as in
+//   topmg_bench -i ToyCaseForTesting/var_mods.txt ToyCaseForTesting/sim_ms2.msalign
+// Each spectrum with a reference peptide is one case. A kernel runs on
+// all cases in one iteration, with the inputs of the kernel prepared
+// outside the timed region. After the warm-up iterations, the times of
+// the timed iterations and the allocations in one iteration are written
+// as JSON, so that runs of different versions can be compared.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "common/util/version.hpp"
+#include "common/base/base_data.hpp"
+#include "common/base/mod_util.hpp"
+#include "ms/spec/msalign_reader.hpp"
+#include "prsm/prsm_para.hpp"
+#include "search/graph/proteo_anno.hpp"
+#include "search/graphalign/graph_align_a.hpp"
+#include "search/graphalign/graph_align_graph.hpp"
+#include "search/graphalign/graph_align_mng.hpp"
+#include "search/graphalign/graph_align_processor.hpp"
+#include "search/graphalign/graph_align_record.hpp"
+#include "search/graphalign/graph_align_table.hpp"
+#include "search/graphalign/graph_candidate_index.hpp"
+#include "search/graphalign/graph_pair_table.hpp"
+
+#include "console/topmg_argument.hpp"
+
+// all allocations of the program are counted, the kernels only read the
+// counters in their timed regions
+static std::atomic<long> bench_alloc_num(0);
+static std::atomic<long> bench_alloc_bytes(0);
+
+void * operator new(std::size_t size) {
+  bench_alloc_num++;
+  bench_alloc_bytes += size;
+  void * p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void * p) noexcept {
+  std::free(p);
+}
+
+namespace toppic {
+
+struct GraphAlignBenchCase {
+  int spec_id_;
+
+  std::string ref_raw_seq_;
+
+  SpectrumSetPtr spec_set_ptr_;
+
+  ProteoGraphPtr proteo_ptr_;
+
+  SpecGraphPtr_sim spec_graph_ptr_;
+};
+
+// Time and allocations of the timed regions of a kernel in one iteration.
+class GraphAlignBenchClock {
+ public:
+  void start() {
+    alloc_start_num_ = bench_alloc_num;
+    alloc_start_bytes_ = bench_alloc_bytes;
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  void stop() {
+    ms_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    alloc_num_ += bench_alloc_num - alloc_start_num_;
+    alloc_bytes_ += bench_alloc_bytes - alloc_start_bytes_;
+  }
+
+  double getMs() {return ms_;}
+
+  long getAllocNum() {return alloc_num_;}
+
+  long getAllocBytes() {return alloc_bytes_;}
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+
+  long alloc_start_num_ = 0;
+
+  long alloc_start_bytes_ = 0;
+
+  double ms_ = 0;
+
+  long alloc_num_ = 0;
+
+  long alloc_bytes_ = 0;
+};
+
+struct GraphAlignBenchResult {
+  std::string name_;
+
+  // times of the timed iterations, sorted
+  std::vector<double> ms_vec_;
+
+  long alloc_num_ = 0;
+
+  long alloc_bytes_ = 0;
+};
+
+class GraphAlignBench {
+ public:
+  GraphAlignBench(GraphAlignMngPtr mng_ptr, ProteoAnnoPtr proteo_anno_ptr,
+                  std::vector<GraphAlignBenchCase> & cases):
+      mng_ptr_(mng_ptr),
+      proteo_anno_ptr_(proteo_anno_ptr),
+      cases_(cases) {}
+
+  void run(int warmup_num, int iter_num);
+
+  void writeJson(std::ostream & out, const std::string & sp_file_name,
+                 int warmup_num, int iter_num);
+
+ private:
+  typedef std::function<void(GraphAlignBenchCase &, GraphAlignBenchClock &)> Kernel;
+
+  void runKernel(const std::string & name, Kernel kernel, int warmup_num, int iter_num);
+
+  GraphAlignPtr_sim geneSim(GraphAlignBenchCase & bench_case, GraphAlignTablePtr table_ptr);
+
+  // a GraphAlignSim whose consistent pairs are ready
+  GraphAlignPtr_sim geneConsPairSim(GraphAlignBenchCase & bench_case, GraphAlignTablePtr table_ptr);
+
+  static double getPercentile(const std::vector<double> & sorted_vec, double p);
+
+  GraphAlignMngPtr mng_ptr_;
+
+  ProteoAnnoPtr proteo_anno_ptr_;
+
+  std::vector<GraphAlignBenchCase> & cases_;
+
+  std::vector<GraphAlignBenchResult> results_;
+};
+
+GraphAlignPtr_sim GraphAlignBench::geneSim(GraphAlignBenchCase & bench_case,
+                                           GraphAlignTablePtr table_ptr) {
+  GraphAlignRecordPtr record_ptr = std::make_shared<GraphAlignRecord>(0);
+  return std::make_shared<GraphAlignSim>(mng_ptr_, bench_case.proteo_ptr_,
+                                         bench_case.spec_graph_ptr_, record_ptr, table_ptr);
+}
+
+GraphAlignPtr_sim GraphAlignBench::geneConsPairSim(GraphAlignBenchCase & bench_case,
+                                                   GraphAlignTablePtr table_ptr) {
+  GraphAlignPtr_sim sim_ptr = geneSim(bench_case, table_ptr);
+  sim_ptr->getDelta();
+  sim_ptr->deleteOverlap_v2();
+  sim_ptr->getSpecDist();
+  sim_ptr->getNewConsPair();
+  return sim_ptr;
+}
+
+void GraphAlignBench::runKernel(const std::string & name, Kernel kernel,
+                                int warmup_num, int iter_num) {
+  GraphAlignBenchResult result;
+  result.name_ = name;
+  for (int it = 0; it < warmup_num + iter_num; it++) {
+    GraphAlignBenchClock clock;
+    for (size_t c = 0; c < cases_.size(); c++) {
+      kernel(cases_[c], clock);
+    }
+    if (it >= warmup_num) {
+      result.ms_vec_.push_back(clock.getMs());
+      // the kernels are deterministic, so the allocations of the last
+      // iteration are reported
+      result.alloc_num_ = clock.getAllocNum();
+      result.alloc_bytes_ = clock.getAllocBytes();
+    }
+  }
+  std::sort(result.ms_vec_.begin(), result.ms_vec_.end());
+  results_.push_back(result);
+}
+
+void GraphAlignBench::run(int warmup_num, int iter_num) {
+  runKernel("proteo_graph", [this](GraphAlignBenchCase & bench_case, GraphAlignBenchClock & clock) {
+    clock.start();
+    ProteoGraphPtr proteo_ptr = geneRefProteoGraph(mng_ptr_, proteo_anno_ptr_, bench_case.spec_id_,
+                                                   bench_case.ref_raw_seq_);
+    clock.stop();
+  }, warmup_num, iter_num);
+
+  runKernel("spec_graph", [this](GraphAlignBenchCase & bench_case, GraphAlignBenchClock & clock) {
+    clock.start();
+    SpecGraphPtr_sim spec_graph_ptr = geneSpecGraph(mng_ptr_, bench_case.spec_set_ptr_, 0);
+    clock.stop();
+  }, warmup_num, iter_num);
+
+  runKernel("cons_pair", [this](GraphAlignBenchCase & bench_case, GraphAlignBenchClock & clock) {
+    GraphAlignTablePtr table_ptr = std::make_shared<GraphAlignTable>();
+    GraphAlignPtr_sim sim_ptr = geneSim(bench_case, table_ptr);
+    sim_ptr->getDelta();
+    sim_ptr->deleteOverlap_v2();
+    sim_ptr->getSpecDist();
+    clock.start();
+    sim_ptr->getNewConsPair();
+    clock.stop();
+  }, warmup_num, iter_num);
+
+  runKernel("dp", [this](GraphAlignBenchCase & bench_case, GraphAlignBenchClock & clock) {
+    GraphAlignTablePtr table_ptr = std::make_shared<GraphAlignTable>();
+    GraphAlignPtr_sim sim_ptr = geneConsPairSim(bench_case, table_ptr);
+    clock.start();
+    sim_ptr->computeTableT(*table_ptr);
+    clock.stop();
+  }, warmup_num, iter_num);
+
+  runKernel("q2", [this](GraphAlignBenchCase & bench_case, GraphAlignBenchClock & clock) {
+    GraphAlignTablePtr table_ptr = std::make_shared<GraphAlignTable>();
+    GraphAlignPtr_sim sim_ptr = geneConsPairSim(bench_case, table_ptr);
+    sim_ptr->computeTableT(*table_ptr);
+    GraphAlignGraph align_graph;
+    if (sim_ptr->ConstructBacktrackingGraph(*table_ptr, align_graph) < 0) {
+      return;
+    }
+    clock.start();
+    GraphPairTable pair_table(align_graph.getVertexNum());
+    std::vector<int> Q2 = sim_ptr->ConstructQ2(align_graph, pair_table);
+    clock.stop();
+  }, warmup_num, iter_num);
+
+  runKernel("find_two_path", [this](GraphAlignBenchCase & bench_case, GraphAlignBenchClock & clock) {
+    GraphAlignTablePtr table_ptr = std::make_shared<GraphAlignTable>();
+    GraphAlignPtr_sim sim_ptr = geneConsPairSim(bench_case, table_ptr);
+    sim_ptr->computeTableT(*table_ptr);
+    GraphAlignGraph align_graph;
+    double max_inten = sim_ptr->ConstructBacktrackingGraph(*table_ptr, align_graph);
+    if (max_inten < 0) {
+      return;
+    }
+    GraphPairTable pair_table(align_graph.getVertexNum());
+    std::vector<int> Q2 = sim_ptr->ConstructQ2(align_graph, pair_table);
+    std::vector<double> D;
+    std::vector<int> B;
+    clock.start();
+    sim_ptr->FindTwoPath(D, B, Q2, align_graph, pair_table, 0.5 * max_inten, 0.5 * max_inten);
+    clock.stop();
+  }, warmup_num, iter_num);
+
+  runKernel("quantification", [this](GraphAlignBenchCase & bench_case, GraphAlignBenchClock & clock) {
+    GraphAlignTablePtr table_ptr = std::make_shared<GraphAlignTable>();
+    GraphAlignPtr_sim sim_ptr = geneConsPairSim(bench_case, table_ptr);
+    sim_ptr->computeTableT(*table_ptr);
+    clock.start();
+    sim_ptr->Quantification(*table_ptr);
+    clock.stop();
+  }, warmup_num, iter_num);
+}
+
+double GraphAlignBench::getPercentile(const std::vector<double> & sorted_vec, double p) {
+  if (sorted_vec.empty()) {
+    return 0;
+  }
+  // nearest rank
+  size_t rank = static_cast<size_t>(std::ceil(p / 100 * sorted_vec.size()));
+  if (rank > 0) {
+    rank--;
+  }
+  return sorted_vec[std::min(rank, sorted_vec.size() - 1)];
+}
+
+void GraphAlignBench::writeJson(std::ostream & out, const std::string & sp_file_name,
+                                int warmup_num, int iter_num) {
+  out << std::fixed << std::setprecision(4);
+  out << "{\"version\":\"" << Version::getVersion() << "\""
+      << ",\"spectrum_file\":\"" << sp_file_name << "\""
+      << ",\"case_num\":" << cases_.size()
+      << ",\"warmup\":" << warmup_num
+      << ",\"iterations\":" << iter_num
+      << ",\"kernels\":[";
+  for (size_t r = 0; r < results_.size(); r++) {
+    GraphAlignBenchResult & result = results_[r];
+    double sum = 0;
+    for (size_t i = 0; i < result.ms_vec_.size(); i++) {
+      sum += result.ms_vec_[i];
+    }
+    double mean = result.ms_vec_.empty() ? 0 : sum / result.ms_vec_.size();
+    if (r > 0) out << ",";
+    out << std::endl << "  {\"name\":\"" << result.name_ << "\""
+        << ",\"min_ms\":" << getPercentile(result.ms_vec_, 0)
+        << ",\"p50_ms\":" << getPercentile(result.ms_vec_, 50)
+        << ",\"p90_ms\":" << getPercentile(result.ms_vec_, 90)
+        << ",\"p99_ms\":" << getPercentile(result.ms_vec_, 99)
+        << ",\"max_ms\":" << getPercentile(result.ms_vec_, 100)
+        << ",\"mean_ms\":" << mean
+        << ",\"allocs\":" << result.alloc_num_
+        << ",\"alloc_bytes\":" << result.alloc_bytes_ << "}";
+  }
+  out << std::endl << "]}" << std::endl;
+}
+
+}  // namespace toppic
+
+int main(int argc, char* argv[]) {
+  namespace po = boost::program_options;
+  int warmup_num = 2;
+  int iter_num = 20;
+  std::string output_file_name = "";
+  po::options_description desc("topmg_bench options");
+  desc.add_options()
+      ("warmup", po::value<int>(&warmup_num), "<a non-negative integer>. Number of untimed iterations. Default value: 2.")
+      ("iterations", po::value<int>(&iter_num), "<a positive integer>. Number of timed iterations. Default value: 20.")
+      ("output", po::value<std::string>(&output_file_name), "<a file name>. JSON output file. Default: standard output.");
+  std::vector<std::string> topmg_args;
+  try {
+    po::parsed_options parsed
+        = po::command_line_parser(argc, argv).options(desc).allow_unregistered().run();
+    po::variables_map vm;
+    po::store(parsed, vm);
+    po::notify(vm);
+    topmg_args = po::collect_unrecognized(parsed.options, po::include_positional);
+  } catch (std::exception & e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    std::cerr << desc << std::endl;
+    return 1;
+  }
+  if (warmup_num < 0 || iter_num <= 0) {
+    std::cerr << desc << std::endl;
+    return 1;
+  }
+  if (topmg_args.empty()) {
+    topmg_args = {"-i", "ToyCaseForTesting/var_mods.txt", "ToyCaseForTesting/sim_ms2.msalign"};
+  }
+
+  std::vector<char*> topmg_argv;
+  topmg_argv.push_back(argv[0]);
+  for (size_t i = 0; i < topmg_args.size(); i++) {
+    topmg_argv.push_back(&topmg_args[i][0]);
+  }
+  toppic::Argument argu_processor;
+  if (!argu_processor.parse(topmg_argv.size(), topmg_argv.data())) {
+    return 1;
+  }
+  std::map<std::string, std::string> arguments = argu_processor.getArguments();
+  std::string sp_file_name = argu_processor.getSpecFileList()[0];
+  arguments["spectrumFileName"] = sp_file_name;
+
+  xercesc::XMLPlatformUtils::Initialize();
+  toppic::base_data::init();
+
+  toppic::PrsmParaPtr prsm_para_ptr = std::make_shared<toppic::PrsmPara>(arguments);
+  int max_mod_num = std::stoi(arguments["varPtmNumber"]);
+  toppic::GraphAlignMngPtr mng_ptr
+      = std::make_shared<toppic::GraphAlignMng>(prsm_para_ptr,
+                                                arguments["varModFileName"],
+                                                std::stoi(arguments["ptmNumber"]),
+                                                max_mod_num,
+                                                std::stoi(arguments["proteoGraphGap"]),
+                                                std::min(std::stoi(arguments["varPtmNumInGap"]), max_mod_num),
+                                                std::stod(arguments["maxPtmMass"]),
+                                                1,
+                                                arguments["wholeProteinOnly"] == "true",
+                                                "topmg_graph_filter", "topmg_graph_align");
+  mng_ptr->abund_search_mode_ = arguments["abundSearchMode"];
+  mng_ptr->abund_search_step_ = std::stod(arguments["abundSearchStep"]);
+  mng_ptr->abund_search_tolerance_ = std::stod(arguments["abundSearchTolerance"]);
+  mng_ptr->dp_thread_num_ = std::stoi(arguments["dpThreadNumber"]);
+  mng_ptr->tolerance_model_ = arguments["toleranceModel"];
+
+  toppic::ModPtrVec var_mod_ptr_vec = toppic::mod_util::readModTxt(mng_ptr->var_mod_file_name_)[2];
+  toppic::ModPtrVec N_mod_ptr_vec = toppic::mod_util::readModTxt(mng_ptr->var_mod_file_name_)[3];
+  for (size_t mm = 0; mm < var_mod_ptr_vec.size(); mm++) {
+    toppic::PtmPtr ptm = var_mod_ptr_vec[mm]->getModResiduePtr()->getPtmPtr();
+    mng_ptr->ptm_map_.insert(std::make_pair(ptm->getUnimodId(), ptm));
+  }
+  toppic::ProteoAnnoPtr proteo_anno_ptr
+      = std::make_shared<toppic::ProteoAnno>(prsm_para_ptr->getFixModPtrVec(),
+                                             prsm_para_ptr->getProtModPtrVec(),
+                                             var_mod_ptr_vec, N_mod_ptr_vec);
+
+  std::string sp_directory = sp_file_name;
+  size_t pos = sp_directory.find_last_of('/');
+  if (pos != std::string::npos) {
+    sp_directory.erase(pos + 1);
+  } else {
+    sp_directory = "";
+  }
+  toppic::GraphCandidateIndexPtr cand_index_ptr
+      = std::make_shared<toppic::GraphCandidateIndex>(sp_directory + "ref_peptide.txt");
+
+  // the kernels print progress messages
+  std::streambuf * cout_buf = std::cout.rdbuf();
+  std::ofstream null_stream;
+  std::cout.rdbuf(null_stream.rdbuf());
+
+  toppic::SpParaPtr sp_para_ptr = prsm_para_ptr->getSpParaPtr();
+  std::vector<toppic::GraphAlignBenchCase> cases;
+  toppic::MsAlignReader sp_reader(sp_file_name, prsm_para_ptr->getGroupSpecNum(),
+                                  sp_para_ptr->getActivationPtr(),
+                                  sp_para_ptr->getSkipList());
+  toppic::SpectrumSetPtr spec_set_ptr = sp_reader.getNextSpectrumSet(sp_para_ptr)[0];
+  while (spec_set_ptr != nullptr) {
+    int spec_id = spec_set_ptr->getSpectrumId();
+    const std::vector<std::string> & cands = cand_index_ptr->getCandidates(spec_id);
+    if (spec_set_ptr->isValid() && !cands.empty()) {
+      // one case for each candidate peptide of the spectrum
+      toppic::SpecGraphPtr_sim spec_graph_ptr = toppic::geneSpecGraph(mng_ptr, spec_set_ptr, 0);
+      for (size_t c = 0; c < cands.size(); c++) {
+        toppic::GraphAlignBenchCase bench_case;
+        bench_case.spec_id_ = spec_id;
+        bench_case.ref_raw_seq_ = cands[c];
+        bench_case.spec_set_ptr_ = spec_set_ptr;
+        bench_case.proteo_ptr_ = toppic::geneRefProteoGraph(mng_ptr, proteo_anno_ptr, spec_id,
+                                                           bench_case.ref_raw_seq_);
+        bench_case.spec_graph_ptr_ = spec_graph_ptr;
+        cases.push_back(bench_case);
+      }
+    }
+    spec_set_ptr = sp_reader.getNextSpectrumSet(sp_para_ptr)[0];
+  }
+  sp_reader.close();
+
+  toppic::GraphAlignBench bench(mng_ptr, proteo_anno_ptr, cases);
+  bench.run(warmup_num, iter_num);
+  std::cout.rdbuf(cout_buf);
+  // writes to the closed null stream set the error state of std::cout
+  std::cout.clear();
+
+  if (output_file_name == "") {
+    bench.writeJson(std::cout, sp_file_name, warmup_num, iter_num);
+  } else {
+    std::ofstream output(output_file_name);
+    bench.writeJson(output, sp_file_name, warmup_num, iter_num);
+    output.close();
+  }
+  return 0;
+}
@@ -0,0 +1,29 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <iostream>
+#include <string>
+
+#include "search/graphalign/graph_align_result_bin.hpp"
+
+// Converts a results.bin file written by topmg --binary-output to the
+// tab separated format of results.txt.
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    std::cout << "Usage: topmg_bin_to_tsv <results.bin> <output tsv file>" << std::endl;
+    return 1;
+  }
+  toppic::graph_align_result_bin::convertToTsv(argv[1], argv[2]);
+  return 0;
+}
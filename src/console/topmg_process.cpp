@@ -293,6 +293,18 @@ int TopMG_identify(std::map<std::string, std::string> & arguments) {
                                           gap, var_ptm_in_gap, max_ptm_mass,
                                           thread_num, whole_protein_only,
                                            "topmg_graph_filter", "topmg_graph_align");
+    ga_mng_ptr->abund_search_mode_ = arguments["abundSearchMode"];
+    ga_mng_ptr->abund_search_step_ = std::stod(arguments["abundSearchStep"]);
+    ga_mng_ptr->abund_search_tolerance_ = std::stod(arguments["abundSearchTolerance"]);
+    ga_mng_ptr->dp_thread_num_ = std::stoi(arguments["dpThreadNumber"]);
+    ga_mng_ptr->proteo_graph_cache_size_ = std::stoi(arguments["proteoGraphCacheSize"]);
+    ga_mng_ptr->binary_output_ = (arguments["binaryOutput"] == "true");
+    ga_mng_ptr->align_stats_ = (arguments["alignStats"] == "true");
+    ga_mng_ptr->prune_min_matched_ = std::stoi(arguments["pruneMinMatched"]);
+    ga_mng_ptr->prune_min_inten_cov_ = std::stod(arguments["pruneMinCoverage"]);
+    ga_mng_ptr->prune_single_path_ = (arguments["pruneSinglePath"] == "true");
+    ga_mng_ptr->mem_budget_mb_ = std::stoi(arguments["memoryBudget"]);
+    ga_mng_ptr->tolerance_model_ = arguments["toleranceModel"];
 
     PrsmParaPtr prsm_para_ptr_test = ga_mng_ptr->prsm_para_ptr_;
     //processDatabase("database.fasta_target_0", prsm_para_ptr_test, var_mod_ptr_vec);
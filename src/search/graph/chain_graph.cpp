@@ -0,0 +1,63 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <vector>
+
+#include "search/graph/chain_graph.hpp"
+
+namespace toppic {
+
+ChainGraph::ChainGraph(int vertex_num):
+    vertex_num_(vertex_num),
+    edge_begin_(vertex_num + 1, 0) {}
+
+void ChainGraph::addEdge(int v, int int_mass, int alter_type, ResiduePtr res_ptr) {
+  ChainEdge edge;
+  edge.int_mass_ = int_mass;
+  edge.alter_type_ = alter_type;
+  edge.res_idx_ = -1;
+  if (res_ptr != nullptr) {
+    auto it = res_idx_map_.find(res_ptr.get());
+    if (it == res_idx_map_.end()) {
+      edge.res_idx_ = res_ptr_vec_.size();
+      res_idx_map_[res_ptr.get()] = edge.res_idx_;
+      res_ptr_vec_.push_back(res_ptr);
+    } else {
+      edge.res_idx_ = it->second;
+    }
+  }
+  edges_.push_back(edge);
+  edge_v_.push_back(v);
+}
+
+void ChainGraph::build() {
+  // stable counting sort of the edges by v
+  edge_begin_.assign(vertex_num_ + 1, 0);
+  for (size_t e = 0; e < edge_v_.size(); e++) {
+    edge_begin_[edge_v_[e] + 1]++;
+  }
+  for (int v = 0; v < vertex_num_; v++) {
+    edge_begin_[v + 1] += edge_begin_[v];
+  }
+  std::vector<int> pos(edge_begin_.begin(), edge_begin_.end() - 1);
+  std::vector<ChainEdge> sorted_edges(edges_.size());
+  for (size_t e = 0; e < edge_v_.size(); e++) {
+    sorted_edges[pos[edge_v_[e]]++] = edges_[e];
+  }
+  edges_.swap(sorted_edges);
+  edge_v_.clear();
+  res_idx_map_.clear();
+}
+
+}  // namespace toppic
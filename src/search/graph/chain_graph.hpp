@@ -0,0 +1,77 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef TOPPIC_SEARCH_GRAPH_CHAIN_GRAPH_HPP_
+#define TOPPIC_SEARCH_GRAPH_CHAIN_GRAPH_HPP_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "common/base/residue.hpp"
+
+namespace toppic {
+
+// An edge from vertex v to v + 1 of a ChainGraph. res_idx_ is the index
+// of the residue of the edge in the graph, -1 for spectrum edges.
+struct ChainEdge {
+  int int_mass_;
+  int alter_type_;
+  int res_idx_;
+};
+
+// A mass graph whose edges only go from a vertex v to v + 1, as in the
+// proteoform and spectrum graphs. After build() the edges are stored by v
+// in one array, in the order they were added, and the edges from v to
+// v + 1 are [getEdgeBegin(v), getEdgeEnd(v)).
+class ChainGraph {
+ public:
+  explicit ChainGraph(int vertex_num);
+
+  void addEdge(int v, int int_mass, int alter_type, ResiduePtr res_ptr);
+
+  void build();
+
+  int getVertexNum() {return vertex_num_;}
+
+  int getEdgeNum() {return edges_.size();}
+
+  int getEdgeBegin(int v) {return edge_begin_[v];}
+
+  int getEdgeEnd(int v) {return edge_begin_[v + 1];}
+
+  const ChainEdge & getEdge(int e) {return edges_[e];}
+
+  ResiduePtr getResiduePtr(int res_idx) {return res_ptr_vec_[res_idx];}
+
+ private:
+  int vertex_num_;
+
+  std::vector<int> edge_begin_;
+
+  std::vector<ChainEdge> edges_;
+
+  // source vertices of the added edges, cleared by build()
+  std::vector<int> edge_v_;
+
+  ResiduePtrVec res_ptr_vec_;
+
+  std::unordered_map<Residue*, int> res_idx_map_;
+};
+
+typedef std::shared_ptr<ChainGraph> ChainGraphPtr;
+
+}  // namespace toppic
+
+#endif
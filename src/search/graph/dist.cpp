@@ -12,38 +12,45 @@
 //See the License for the specific language governing permissions and
 //limitations under the License.
 
-#include <algorithm>
+#include <functional>
+#include <queue>
 
 #include "search/graph/dist.hpp"
 
 namespace toppic {
 
-int getVecIndex(int v1, int v2, int gap) {
-  int index = (gap + 1) * v1 + (v2 - v1);
-  return index;
-}
+void mergeDistRuns(const std::vector<DistEntry> & entries,
+                   const std::vector<DistRun> & runs, DistVec & dist_vec) {
+  // (mass, run index) of the next entry of each run, so runs with the
+  // same mass are taken in (i, j) order
+  typedef std::pair<int, int> HeapItem;
+  std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>> heap;
+  std::vector<int> pos(runs.size());
+  for (size_t r = 0; r < runs.size(); r++) {
+    pos[r] = runs[r].begin_;
+    if (pos[r] < runs[r].end_) {
+      heap.push(std::make_pair(entries[pos[r]].dist_, r));
+    }
+  }
 
-void addToDistVec(MassGraphPtr graph_ptr, const std::vector<std::vector<std::set<std::pair<int, std::vector<std::pair<unsigned short,unsigned short>>>>>> & dist_vecs,
-                  int node_num, int mod_num, DistVec & dist_vec, int gap) {
-  std::set<Dist> dist_set;
-  for (int i = 0; i < node_num - 1; i++) {
-    for (int j = i + 1; j < node_num && j <= i + gap; j++) {
-      int index = getVecIndex(i, j, gap);
-      for (auto it=dist_vecs[index][mod_num].begin();
-           it != dist_vecs[index][mod_num].end(); it++) {
-        if ((*it).first == 0) continue;
-        Dist tmp = Dist(graph_ptr, (*it).first, i, j, (*it).second);
-        auto search = dist_set.find(tmp);
-        if (search != dist_set.end()) {
-          search->pair_ij_.push_back(std::make_pair(std::pair<int, int>(i, j),(*it).second));
-        } else {
-          dist_set.insert(tmp);
-        }
+  while (!heap.empty()) {
+    int mass = heap.top().first;
+    int r = heap.top().second;
+    heap.pop();
+    if (mass != 0) {
+      const DistRun & run = runs[r];
+      ModListId mod_id = entries[pos[r]].mod_list_id_;
+      if (dist_vec.empty() || dist_vec.back().dist_ != mass) {
+        dist_vec.push_back(Dist(mass, run.i_, run.j_, mod_id));
+      } else {
+        dist_vec.back().pair_ij_.push_back(std::make_pair(std::make_pair(run.i_, run.j_), mod_id));
       }
     }
+    pos[r]++;
+    if (pos[r] < runs[r].end_) {
+      heap.push(std::make_pair(entries[pos[r]].dist_, r));
+    }
   }
-
-  std::copy(dist_set.begin(), dist_set.end(), std::back_inserter(dist_vec));
 }
 
 }  // namespace toppic
@@ -17,7 +17,6 @@
 #define TOPPIC_SEARCH_GRAPH_DIST_HPP_
 
 #include <utility>
-#include <set>
 #include <vector>
 
 #include "search/graph/graph.hpp"
@@ -26,24 +25,18 @@ namespace toppic {
 
 class Dist{
  public:
-  Dist(MassGraphPtr graph_ptr, int d, int i, int j, std::vector<std::pair<unsigned short,unsigned short>> modInfo) {
-    graph_ptr_ = graph_ptr;
+  Dist(int d, int i, int j, ModListId mod_id) {
     dist_ = d;
-    pair_ij_.push_back(std::make_pair(std::pair<int, int>(i, j), modInfo));
+    pair_ij_.push_back(std::make_pair(std::pair<int, int>(i, j), mod_id));
   }
 
   bool operator< (const Dist& d) const {
     return dist_ < d.dist_;
   }
 
-  mutable std::vector<std::pair<std::pair<int, int>, std::vector<std::pair<unsigned short,unsigned short>>>> pair_ij_;
+  mutable std::vector<std::pair<std::pair<int, int>, ModListId>> pair_ij_;
 
   int dist_;
-
-  MassGraphPtr getGraphPtr() {return graph_ptr_;}
-
- private:
-  MassGraphPtr graph_ptr_;
 };
 
 typedef std::vector<Dist> DistVec;
@@ -53,10 +46,26 @@ inline bool distVecUp(const Dist & a, const Dist & b) {
   return a.dist_ < b.dist_;
 }
 
-void addToDistVec(MassGraphPtr graph_ptr,
-                  const std::vector<std::vector<std::set<std::pair<int, std::vector<std::pair<unsigned short,unsigned short>>>>>> & dist_vecs,
-                  int node_num, int mod_num, DistVec & dist_vec,
-                  int gap);
+// a path of a proteoform graph: its mass and modification list
+struct DistEntry {
+  int dist_;
+  ModListId mod_list_id_;
+};
+
+// the paths from vertex i_ to vertex j_ with the same number of variable
+// modifications, stored in [begin_, end_) of an entry array and sorted by
+// mass
+struct DistRun {
+  int i_;
+  int j_;
+  int begin_;
+  int end_;
+};
+
+// Merges runs given in (i, j) order into dist_vec. Paths of mass 0 are
+// skipped and paths with the same mass are added to one Dist in run order.
+void mergeDistRuns(const std::vector<DistEntry> & entries,
+                   const std::vector<DistRun> & runs, DistVec & dist_vec);
 
 }  // namespace toppic
 
@@ -30,6 +30,7 @@
 #include "common/base/residue.hpp"
 #include "common/util/logger.hpp"
 #include "seq/alter.hpp"
+#include "search/graph/mod_list_pool.hpp"
 
 namespace toppic {
 
@@ -87,17 +88,15 @@ struct VertexInfo_AGraph {
 struct EdgeInfo_AGraph {
   int blackMass_;
   int exactMass_;
-  std::vector<std::pair<unsigned short, unsigned short>> ModInfo_;
+  // id of the mod list in the ModListPool of the proteoform graph
+  ModListId mod_list_id_;
 
-  EdgeInfo_AGraph():blackMass_(-1),exactMass_(-1) {
-    std::vector<std::pair<unsigned short, unsigned short>> ModInfo;
-    ModInfo_ = ModInfo;
-  }
+  EdgeInfo_AGraph():blackMass_(-1),exactMass_(-1),mod_list_id_(ModListPool::EMPTY_ID) {}
 
-  EdgeInfo_AGraph(int blackMass, int exactMass, std::vector<std::pair<unsigned short, unsigned short>> ModInfo):
+  EdgeInfo_AGraph(int blackMass, int exactMass, ModListId mod_list_id):
     blackMass_(blackMass),
     exactMass_(exactMass),
-    ModInfo_(ModInfo){}
+    mod_list_id_(mod_list_id){}
 };
 
 struct GraphInfo_AGraph {
@@ -0,0 +1,38 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "search/graph/mod_list_pool.hpp"
+
+namespace toppic {
+
+const ModListId ModListPool::EMPTY_ID;
+
+ModListId ModListPool::intern(const GraphModList & mods) {
+  std::unordered_map<GraphModList, ModListId, GraphModListHash>::iterator it = id_map_.find(mods);
+  if (it != id_map_.end()) {
+    return it->second;
+  }
+  ModListId id = lists_.size();
+  it = id_map_.insert(std::make_pair(mods, id)).first;
+  lists_.push_back(&(it->first));
+  return id;
+}
+
+ModListId ModListPool::append(ModListId id, const GraphModInfo & mod) {
+  GraphModList mods = *lists_[id];
+  mods.push_back(mod);
+  return intern(mods);
+}
+
+}  // namespace toppic
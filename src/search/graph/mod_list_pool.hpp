@@ -0,0 +1,73 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef TOPPIC_SEARCH_GRAPH_MOD_LIST_POOL_HPP_
+#define TOPPIC_SEARCH_GRAPH_MOD_LIST_POOL_HPP_
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace toppic {
+
+// a modification: <unimod id, position>
+typedef std::pair<unsigned short, unsigned short> GraphModInfo;
+
+typedef std::vector<GraphModInfo> GraphModList;
+
+typedef unsigned int ModListId;
+
+struct GraphModListHash {
+  size_t operator()(const GraphModList & mods) const {
+    size_t seed = mods.size();
+    for (size_t i = 0; i < mods.size(); i++) {
+      size_t v = (static_cast<size_t>(mods[i].first) << 16) | mods[i].second;
+      seed ^= v + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  }
+};
+
+// Stores each distinct modification list once. Distances, consistent
+// pairs, T/E predecessors and alignment graph edges keep the 32-bit id
+// of a list and resolve it with getModList when the output is written.
+// The empty list always has id EMPTY_ID.
+class ModListPool {
+ public:
+  static const ModListId EMPTY_ID = 0;
+
+  ModListPool() {intern(GraphModList());}
+
+  ModListId intern(const GraphModList & mods);
+
+  // id of the list mods(id) + mod
+  ModListId append(ModListId id, const GraphModInfo & mod);
+
+  const GraphModList & getModList(ModListId id) {return *lists_[id];}
+
+  int getListNum() {return lists_.size();}
+
+ private:
+  std::unordered_map<GraphModList, ModListId, GraphModListHash> id_map_;
+
+  // keys of id_map_, the nodes of an unordered_map do not move
+  std::vector<const GraphModList *> lists_;
+};
+
+typedef std::shared_ptr<ModListPool> ModListPoolPtr;
+
+}  // namespace toppic
+
+#endif
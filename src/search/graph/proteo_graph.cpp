@@ -12,6 +12,8 @@
 //See the License for the specific language governing permissions and
 //limitations under the License.
 
+#include <algorithm>
+#include <limits>
 #include <set>
 #include <vector>
 
@@ -29,7 +31,7 @@
 namespace toppic {
 
 ProteoGraph::ProteoGraph(FastaSubSeqPtr fasta_seq_ptr, ModPtrVec fix_mod_ptr_vec,
-                         MassGraphPtr graph_ptr, bool is_nme,
+                         ChainGraphPtr graph_ptr, bool is_nme,
                          double convert_ratio, int max_mod_num,
                          int max_ptm_sum_mass, int proteo_graph_gap,
                          int var_ptm_in_gap):
@@ -40,8 +42,9 @@ ProteoGraph::ProteoGraph(FastaSubSeqPtr fasta_seq_ptr, ModPtrVec fix_mod_ptr_vec
       db_proteo_ptr_ = proteoform_util::geneDbProteoformPtr(fasta_seq_ptr, fix_mod_ptr_vec,
                                                             fasta_seq_ptr->getSubSeqStart());
       graph_ptr_ = graph_ptr;
+      mod_list_pool_ptr_ = std::make_shared<ModListPool>();
 
-      node_num_ = num_vertices(*graph_ptr.get());
+      node_num_ = graph_ptr->getVertexNum();
       LOG_DEBUG("node num " << node_num_);
       pair_num_ = node_num_ * (proteo_graph_gap_ + 1);
       //std::cout << "compSeqMasses" << std::endl;
@@ -78,87 +81,79 @@ void ProteoGraph::compSeqMasses(double convert_ratio) {
 }
 
 void ProteoGraph::compAddedPrecs(int max_mod_num, int max_ptm_sum_mass){
-    MassGraph *g_p = graph_ptr_.get();
+    ChainGraph *g_p = graph_ptr_.get();
     // get mass without ptms
 
-    std::vector<std::vector<std::set<std::pair<int, std::vector<std::pair<unsigned short,unsigned short>>>>>> dist_vecs;
+    std::vector<std::vector<std::set<std::pair<int, ModListId>>>> dist_vecs;
     for (int i = 0; i < node_num_; i++) {
         //std::vector<std::pair<double,int>> empty_mod;
-        std::set<std::pair<int, std::vector<std::pair<unsigned short,unsigned short>>>> empty_set; //needs to be conformed
-        std::vector<std::set<std::pair<int, std::vector<std::pair<unsigned short,unsigned short>>>> > one_pair_vec;
+        std::set<std::pair<int, ModListId>> empty_set; //needs to be conformed
+        std::vector<std::set<std::pair<int, ModListId>> > one_pair_vec;
         for (int j = 0; j < max_mod_num + 1; j ++) {
             one_pair_vec.push_back(empty_set);
         }
         dist_vecs.push_back(one_pair_vec);
     }
     //initialize 0,0
-    std::vector<std::pair<unsigned short,unsigned short>> empty_mod;
-    dist_vecs[0][0].insert(std::make_pair(0, empty_mod));
+    dist_vecs[0][0].insert(std::make_pair(0, ModListPool::EMPTY_ID));
 
     for (int j =  1; j < node_num_; j++) {
-        Vertex v2 = vertex(j, *g_p);
-        Vertex pre_v2 = vertex(j-1, *g_p);
         int index = j;
         int pre_index = j - 1;
-        boost::graph_traits<MassGraph>::out_edge_iterator ei, ei_end;
-        boost::tie(ei, ei_end) = out_edges(pre_v2, *g_p);
-        for ( ; ei != ei_end; ++ei) {
-            if (target(*ei, *g_p) == v2) {
-                MassGraph::edge_descriptor e = *ei;
-                int d =(*g_p)[e].int_mass_;
-                int change = (*g_p)[e].alter_type_;
-                if(index == 6){
-                    std::cout<<"===="<<d<<std::endl;
+        for (int e = g_p->getEdgeBegin(j - 1); e < g_p->getEdgeEnd(j - 1); e++) {
+            const ChainEdge & edge = g_p->getEdge(e);
+            int d = edge.int_mass_;
+            int change = edge.alter_type_;
+            if(index == 6){
+                std::cout<<"===="<<d<<std::endl;
+            }
+            for (int k = 0; k < var_ptm_in_gap_ + 1; k++) {
+                if (k == max_mod_num &&
+                    (change == AlterType::PROTEIN_VARIABLE->getId()
+                     || change == AlterType::VARIABLE->getId())) {
+                    continue;
                 }
-                for (int k = 0; k < var_ptm_in_gap_ + 1; k++) {
-                    if (k == max_mod_num &&
-                        (change == AlterType::PROTEIN_VARIABLE->getId()
-                         || change == AlterType::VARIABLE->getId())) {
-                        continue;
+                for (auto it=dist_vecs[pre_index][k].begin();
+                     it != dist_vecs[pre_index][k].end(); it++) {
+                    int new_d = d + (*it).first;
+                    if(index == 6){
+                        std::cout<<"newd "<<new_d<<std::endl;
                     }
-                    for (auto it=dist_vecs[pre_index][k].begin();
-                         it != dist_vecs[pre_index][k].end(); it++) {
-                        int new_d = d + (*it).first;
-                        if(index == 6){
-                            std::cout<<"newd "<<new_d<<std::endl;
-                        }
-                        if (std::abs(new_d - seq_masses_[index]) <= max_ptm_sum_mass) {
-                            if (change == AlterType::PROTEIN_VARIABLE->getId()
-                                || change == AlterType::VARIABLE->getId()) {
-                                //dist_vecs[index][k+1].insert(new_d);
-                                bool add1 = true;
-                                if(dist_vecs[index][k+1].size() > 0){
-                                    for(auto iter_a = dist_vecs[index][k+1].begin(); iter_a != dist_vecs[index][k+1].end(); iter_a++){
-                                        if((*iter_a).first == new_d){
-                                            add1 = false;
-                                            break;
-                                        }
+                    if (std::abs(new_d - seq_masses_[index]) <= max_ptm_sum_mass) {
+                        if (change == AlterType::PROTEIN_VARIABLE->getId()
+                            || change == AlterType::VARIABLE->getId()) {
+                            //dist_vecs[index][k+1].insert(new_d);
+                            bool add1 = true;
+                            if(dist_vecs[index][k+1].size() > 0){
+                                for(auto iter_a = dist_vecs[index][k+1].begin(); iter_a != dist_vecs[index][k+1].end(); iter_a++){
+                                    if((*iter_a).first == new_d){
+                                        add1 = false;
+                                        break;
                                     }
                                 }
-                                if(add1 == true){
-                                    unsigned short unID = (*g_p)[e].res_ptr_->getPtmPtr()->getUnimodId();
-                                    auto oldMod = (*it).second;
-                                    oldMod.push_back(std::make_pair(unID, j));
-                                    dist_vecs[index][k+1].insert(std::make_pair(new_d, oldMod));
-                                    //std::cout << "add: dist_vecs[" << index << "][" <<  k+1 << "]: (" << new_d << "," << oldMod.size() << std::endl;
-                                }
-                            } else {
-                                bool add2 = true;
-                                if(dist_vecs[index][k].size() > 0){
-                                    for(auto iter_b = dist_vecs[index][k].begin(); iter_b != dist_vecs[index][k].end(); iter_b++){
-                                        if((*iter_b).first == new_d){
-                                            add2 = false;
-                                            break;
-                                        }
+                            }
+                            if(add1 == true){
+                                unsigned short unID = g_p->getResiduePtr(edge.res_idx_)->getPtmPtr()->getUnimodId();
+                                ModListId new_mod_id = mod_list_pool_ptr_->append((*it).second, std::make_pair(unID, j));
+                                dist_vecs[index][k+1].insert(std::make_pair(new_d, new_mod_id));
+                                //std::cout << "add: dist_vecs[" << index << "][" <<  k+1 << "]: (" << new_d << "," << oldMod.size() << std::endl;
+                            }
+                        } else {
+                            bool add2 = true;
+                            if(dist_vecs[index][k].size() > 0){
+                                for(auto iter_b = dist_vecs[index][k].begin(); iter_b != dist_vecs[index][k].end(); iter_b++){
+                                    if((*iter_b).first == new_d){
+                                        add2 = false;
+                                        break;
                                     }
                                 }
-                                if(add2 == true){
-                                    if(index==6){
-                                        std::cout<<"+_+_+_"<<new_d<<std::endl;
-                                    }
-                                    dist_vecs[index][k].insert(std::make_pair(new_d, (*it).second));
-                                    //std::cout << "add: dist_vecs[" << index << "][" <<  k << "]: (" << new_d << "," << (*it).second.size() << std::endl;
+                            }
+                            if(add2 == true){
+                                if(index==6){
+                                    std::cout<<"+_+_+_"<<new_d<<std::endl;
                                 }
+                                dist_vecs[index][k].insert(std::make_pair(new_d, (*it).second));
+                                //std::cout << "add: dist_vecs[" << index << "][" <<  k << "]: (" << new_d << "," << (*it).second.size() << std::endl;
                             }
                         }
                     }
@@ -199,134 +194,111 @@ void ProteoGraph::compAddedPrecs(int max_mod_num, int max_ptm_sum_mass){
 
 
 void ProteoGraph::compDistances(int max_mod_num, int max_ptm_sum_mass) {
-  MassGraph *g_p = graph_ptr_.get();
-  // get mass without ptms
+  ChainGraph *g_p = graph_ptr_.get();
+  int var_id = AlterType::VARIABLE->getId();
+  int prot_var_id = AlterType::PROTEIN_VARIABLE->getId();
+  // paths with at most var_ptm_in_gap_ mods are extended
+  int src_k_num = std::min(var_ptm_in_gap_, max_mod_num) + 1;
 
-  std::vector<std::vector<std::set<std::pair<int, std::vector<std::pair<unsigned short,unsigned short>>>>>> dist_vecs;
-  for (int i = 0; i < pair_num_; i++) {
-    //std::vector<std::pair<double,int>> empty_mod;
-    std::set<std::pair<int, std::vector<std::pair<unsigned short,unsigned short>>>> empty_set; //needs to be conformed
-    std::vector<std::set<std::pair<int, std::vector<std::pair<unsigned short,unsigned short>>>> > one_pair_vec;
-    for (int j = 0; j < max_mod_num + 1; j ++) {
-      one_pair_vec.push_back(empty_set);
-    }
-    dist_vecs.push_back(one_pair_vec);
-  }
+  // the paths with k mods, one run per (i, j) in (i, j) order
+  std::vector<std::vector<DistEntry>> entries(max_mod_num + 1);
+  std::vector<std::vector<DistRun>> runs(max_mod_num + 1);
 
+  // the path (i, i)
+  DistEntry origin;
+  origin.dist_ = 0;
+  origin.mod_list_id_ = ModListPool::EMPTY_ID;
+
+  // new paths of (i, j) in the order they are found; the first path of
+  // each mass is kept
+  struct Cand {
+    int dist_;
+    ModListId mod_list_id_;
+    int unimod_id_;
+  };
+  std::vector<Cand> cands;
+  std::vector<int> prev_begin(max_mod_num + 1), prev_end(max_mod_num + 1);
+  std::vector<int> cur_begin(max_mod_num + 1), cur_end(max_mod_num + 1);
 
-  // initialize pair (i, i)
-  for (int i = 0; i < node_num_; i++) {
-    int index = getVecIndex(i, i);
-        std::vector<std::pair<unsigned short,unsigned short>> empty_mod;
-        dist_vecs[index][0].insert(std::make_pair(0, empty_mod));
-  }
-  //std::cout << "if here" << std::endl;
   for (int i = 0; i < node_num_ - 1; i++) {
     for (int j = i + 1; j < node_num_ && j <= i + proteo_graph_gap_; j++) {
-      Vertex v2 = vertex(j, *g_p);
-      Vertex pre_v2 = vertex(j-1, *g_p);
-      int index = getVecIndex(i, j);
-      int pre_index = getVecIndex(i, j-1);
-      boost::graph_traits<MassGraph>::out_edge_iterator ei, ei_end;
-      boost::tie(ei, ei_end) = out_edges(pre_v2, *g_p);
-      for ( ; ei != ei_end; ++ei) {
-        if (target(*ei, *g_p) == v2) {
-          MassGraph::edge_descriptor e = *ei;
-          int d =(*g_p)[e].int_mass_;
-          int change = (*g_p)[e].alter_type_;
-//          if(index == 6){
-//              std::cout<<"===="<<d<<std::endl;
-//          }
-          for (int k = 0; k < var_ptm_in_gap_ + 1; k++) {
-            if (k == max_mod_num &&
-                (change == AlterType::PROTEIN_VARIABLE->getId()
-                 || change == AlterType::VARIABLE->getId())) {
-              continue;
-            }
-            for (auto it=dist_vecs[pre_index][k].begin();
-                 it != dist_vecs[pre_index][k].end(); it++) {
-              int new_d = d + (*it).first;
-//              if(index == 6){
-//                  std::cout<<"newd "<<new_d<<std::endl;
-//              }
-              if (std::abs(new_d - seq_masses_[index]) <= max_ptm_sum_mass) {
-                if (change == AlterType::PROTEIN_VARIABLE->getId()
-                    || change == AlterType::VARIABLE->getId()) {
-                  //dist_vecs[index][k+1].insert(new_d);
-                  bool add1 = true;
-                  if(dist_vecs[index][k+1].size() > 0){
-                    for(auto iter_a = dist_vecs[index][k+1].begin(); iter_a != dist_vecs[index][k+1].end(); iter_a++){
-                      if((*iter_a).first == new_d){
-                        add1 = false;
-                        break;
-                      }
-                    }
-                  }
-                  if(add1 == true){
-                    unsigned short unID = (*g_p)[e].res_ptr_->getPtmPtr()->getUnimodId();
-                    auto oldMod = (*it).second;
-                    oldMod.push_back(std::make_pair(unID, j));
-                    dist_vecs[index][k+1].insert(std::make_pair(new_d, oldMod));
-                    //std::cout << "add: dist_vecs[" << index << "][" <<  k+1 << "]: (" << new_d << "," << oldMod.size() << std::endl;
-                  }
-                } else {
-                  bool add2 = true;
-                  if(dist_vecs[index][k].size() > 0){
-                    for(auto iter_b = dist_vecs[index][k].begin(); iter_b != dist_vecs[index][k].end(); iter_b++){
-                      if((*iter_b).first == new_d){
-                        add2 = false;
-                        break;
-                      }
-                    }
-                  }
-                  if(add2 == true){
-//                    if(index==6){
-//                        std::cout<<"+_+_+_"<<new_d<<std::endl;
-//                    }
-                    dist_vecs[index][k].insert(std::make_pair(new_d, (*it).second));
-                    //std::cout << "add: dist_vecs[" << index << "][" <<  k << "]: (" << new_d << "," << (*it).second.size() << std::endl;
-                  }
-                }
-              }
-            }
+      int seq_mass = seq_masses_[getVecIndex(i, j)];
+      for (int kt = 0; kt < max_mod_num + 1; kt++) {
+        cands.clear();
+        for (int e = g_p->getEdgeBegin(j - 1); e < g_p->getEdgeEnd(j - 1); e++) {
+          const ChainEdge & edge_info = g_p->getEdge(e);
+          bool is_var = edge_info.alter_type_ == var_id || edge_info.alter_type_ == prot_var_id;
+          int k = is_var ? kt - 1 : kt;
+          if (k < 0 || k >= src_k_num) {
+            continue;
+          }
+          const DistEntry * src_begin;
+          const DistEntry * src_end;
+          if (j == i + 1) {
+            src_begin = &origin;
+            src_end = k == 0 ? src_begin + 1 : src_begin;
+          } else {
+            src_begin = entries[k].data() + prev_begin[k];
+            src_end = entries[k].data() + prev_end[k];
+          }
+          int d = edge_info.int_mass_;
+          // sources are sorted by mass, so the ones within the ptm mass
+          // limit are a range
+          DistEntry low;
+          low.dist_ = seq_mass - max_ptm_sum_mass - d;
+          const DistEntry * it = std::lower_bound(src_begin, src_end, low,
+                                                  [](const DistEntry & a, const DistEntry & b) {
+                                                    return a.dist_ < b.dist_;});
+          int unimod_id = is_var ? g_p->getResiduePtr(edge_info.res_idx_)->getPtmPtr()->getUnimodId() : -1;
+          for (; it != src_end && it->dist_ + d - seq_mass <= max_ptm_sum_mass; ++it) {
+            Cand cand;
+            cand.dist_ = it->dist_ + d;
+            cand.mod_list_id_ = it->mod_list_id_;
+            cand.unimod_id_ = unimod_id;
+            cands.push_back(cand);
           }
         }
-      }
-      //For one index, here is the ending for building it.
-      /*
-      auto a = dist_vecs[index];
-      for(int i1 = 0; i1 < a.size(); i1++){
-        std::cout << "dist_vecs[" << index << "][" << i1 << "]: {";
-        auto b = a[i1];
-        for(auto i2 = b.begin(); i2 != b.end(); i2++){
-          std::cout << "(" << (*i2).first << ",";
-          auto c = (*i2).second;
-          for(int i3 = 0; i3 < c.size(); i3++){
-            std::cout << "<" << c[i3].first << "," << c[i3].second << ">";
+        std::stable_sort(cands.begin(), cands.end(),
+                         [](const Cand & a, const Cand & b) {return a.dist_ < b.dist_;});
+        cur_begin[kt] = entries[kt].size();
+        for (size_t c = 0; c < cands.size(); c++) {
+          if (c > 0 && cands[c].dist_ == cands[c - 1].dist_) {
+            continue;
+          }
+          DistEntry entry;
+          entry.dist_ = cands[c].dist_;
+          entry.mod_list_id_ = cands[c].mod_list_id_;
+          if (cands[c].unimod_id_ >= 0) {
+            GraphModInfo mod(static_cast<unsigned short>(cands[c].unimod_id_), j);
+            entry.mod_list_id_ = mod_list_pool_ptr_->append(cands[c].mod_list_id_, mod);
           }
-          std::cout << ")";
+          entries[kt].push_back(entry);
+        }
+        cur_end[kt] = entries[kt].size();
+        if (cur_end[kt] > cur_begin[kt]) {
+          DistRun run;
+          run.i_ = i;
+          run.j_ = j;
+          run.begin_ = cur_begin[kt];
+          run.end_ = cur_end[kt];
+          runs[kt].push_back(run);
         }
-        std::cout << "}" << std::endl;
       }
-      */
+      prev_begin.swap(cur_begin);
+      prev_end.swap(cur_end);
     }
   }
-  //std::cout << "end here" << std::endl;
-
 
-
-
-  dist_vec_.reserve(max_mod_num);
-  DistVec tmp;
+  dist_vec_.resize(max_mod_num + 1);
+  min_dist_ = std::numeric_limits<int>::max();
+  max_dist_ = std::numeric_limits<int>::min();
   for (int k = 0; k < max_mod_num + 1; k++) {
-    dist_vec_.push_back(tmp);
-  }
-
-  for (int k = 0; k < max_mod_num + 1; k++) {
-    addToDistVec(graph_ptr_, dist_vecs, node_num_, k, dist_vec_[k], proteo_graph_gap_);
+    mergeDistRuns(entries[k], runs[k], dist_vec_[k]);
+    if (!dist_vec_[k].empty()) {
+      min_dist_ = std::min(min_dist_, dist_vec_[k].front().dist_);
+      max_dist_ = std::max(max_dist_, dist_vec_[k].back().dist_);
+    }
   }
-  //std::cout << "end" << std::endl;
 }
 
 }  // namespace toppic
-
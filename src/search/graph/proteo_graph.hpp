@@ -18,16 +18,16 @@
 
 #include "seq/fasta_seq.hpp"
 #include "seq/proteoform.hpp"
+#include "search/graph/chain_graph.hpp"
 #include "search/graph/dist.hpp"
 #include "search/graph/graph.hpp"
-#include "search/graphalign/graph_align_processor.hpp"
 
 namespace toppic {
 
 class ProteoGraph {
  public:
   ProteoGraph(FastaSubSeqPtr seq_ptr, ModPtrVec fix_mod_ptr_vec,
-              MassGraphPtr graph_ptr, bool is_nme, 
+              ChainGraphPtr graph_ptr, bool is_nme,
               double convert_ratio, int max_mod_num,
               int max_ptm_sum_mass, int proteo_graph_gap,
               int var_ptm_in_gap);
@@ -38,12 +38,22 @@ class ProteoGraph {
 
   ProteoformPtr getProteoformPtr() {return db_proteo_ptr_;}
 
-  MassGraphPtr getMassGraphPtr() {return graph_ptr_;}
+  ChainGraphPtr getChainGraphPtr() {return graph_ptr_;}
+
+  ModListPoolPtr getModListPoolPtr() {return mod_list_pool_ptr_;}
 
   bool isNme() {return is_nme_;}
 
+  // distances by number of variable mods, each sorted by dist_; the
+  // graph is not changed after it is built, so aligners read them in place
   const DistVec2D& getDistVec2D() {return dist_vec_;}
 
+  // the smallest and largest distance in getDistVec2D(), max < min if
+  // there is none
+  int getMinDist() {return min_dist_;}
+
+  int getMaxDist() {return max_dist_;}
+
     std::set<int>getPrecMassSet(){return prec_mass_set_; }
 
 
@@ -61,7 +71,9 @@ class ProteoGraph {
 
   std::vector<int> seq_masses_;
 
-  MassGraphPtr graph_ptr_;
+  ChainGraphPtr graph_ptr_;
+
+  ModListPoolPtr mod_list_pool_ptr_;
 
   bool is_nme_;
 
@@ -71,6 +83,10 @@ class ProteoGraph {
 
   DistVec2D dist_vec_;
 
+  int min_dist_ = 1;
+
+  int max_dist_ = 0;
+
   void compSeqMasses(double convert_ratio);
 
   void compDistances(int max_mod_num, int max_ptm_sum_mass);
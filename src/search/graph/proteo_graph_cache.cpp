@@ -0,0 +1,112 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "common/base/residue.hpp"
+#include "search/graph/proteo_graph_cache.hpp"
+
+namespace toppic {
+
+ProteoGraphPtr ProteoGraphCache::get(const std::string & seq, const std::string & setting_key,
+                                     const BuildFunc & build) {
+  if (max_byte_num_ == 0) {
+    return build();
+  }
+  std::string key = setting_key + "\t" + seq;
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    auto it = entry_map_.find(key);
+    if (it != entry_map_.end()) {
+      lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_it_);
+      hit_num_++;
+      return it->second.graph_ptr_;
+    }
+    miss_num_++;
+  }
+
+  ProteoGraphPtr graph_ptr = build();
+  size_t byte_num = estimateByteNum(graph_ptr);
+  if (byte_num > max_byte_num_) {
+    return graph_ptr;
+  }
+
+  boost::mutex::scoped_lock lock(mutex_);
+  auto it = entry_map_.find(key);
+  if (it != entry_map_.end()) {
+    lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_it_);
+    return it->second.graph_ptr_;
+  }
+  while (byte_num_ + byte_num > max_byte_num_) {
+    auto old_it = entry_map_.find(lru_list_.back());
+    byte_num_ -= old_it->second.byte_num_;
+    entry_map_.erase(old_it);
+    lru_list_.pop_back();
+  }
+  lru_list_.push_front(key);
+  Entry entry;
+  entry.graph_ptr_ = graph_ptr;
+  entry.byte_num_ = byte_num;
+  entry.lru_it_ = lru_list_.begin();
+  entry_map_[key] = entry;
+  byte_num_ += byte_num;
+  return graph_ptr;
+}
+
+std::string ProteoGraphCache::geneSettingKey(const ModPtrVec & fix_mod_ptr_vec,
+                                             const ModPtrVec & var_mod_ptr_vec,
+                                             const ModPtrVec & n_mod_ptr_vec,
+                                             int proteo_graph_gap, int var_ptm_in_gap,
+                                             int max_known_mods) {
+  std::stringstream ss;
+  const ModPtrVec * mod_vecs[3] = {&fix_mod_ptr_vec, &var_mod_ptr_vec, &n_mod_ptr_vec};
+  for (int v = 0; v < 3; v++) {
+    for (size_t m = 0; m < mod_vecs[v]->size(); m++) {
+      ModPtr mod_ptr = (*mod_vecs[v])[m];
+      ss << mod_ptr->getOriResiduePtr()->toString() << ">"
+          << mod_ptr->getModResiduePtr()->toString() << ",";
+    }
+    ss << ";";
+  }
+  ss << proteo_graph_gap << ";" << var_ptm_in_gap << ";" << max_known_mods;
+  return ss.str();
+}
+
+size_t ProteoGraphCache::estimateByteNum(ProteoGraphPtr graph_ptr) {
+  size_t byte_num = sizeof(ProteoGraph);
+
+  const DistVec2D & dist_vec = graph_ptr->getDistVec2D();
+  for (size_t i = 0; i < dist_vec.size(); i++) {
+    byte_num += dist_vec[i].capacity() * sizeof(Dist);
+    for (size_t d = 0; d < dist_vec[i].size(); d++) {
+      byte_num += dist_vec[i][d].pair_ij_.capacity() * sizeof(dist_vec[i][d].pair_ij_[0]);
+    }
+  }
+
+  ChainGraphPtr chain_graph_ptr = graph_ptr->getChainGraphPtr();
+  byte_num += (chain_graph_ptr->getVertexNum() + 1) * sizeof(int);
+  byte_num += chain_graph_ptr->getEdgeNum() * sizeof(ChainEdge);
+
+  // lists and their hash map nodes
+  ModListPoolPtr pool_ptr = graph_ptr->getModListPoolPtr();
+  for (int id = 0; id < pool_ptr->getListNum(); id++) {
+    byte_num += pool_ptr->getModList(id).capacity() * sizeof(GraphModInfo)
+        + sizeof(GraphModList) + 64;
+  }
+  return byte_num;
+}
+
+}  // namespace toppic
@@ -0,0 +1,91 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef TOPPIC_SEARCH_GRAPH_PROTEO_GRAPH_CACHE_HPP_
+#define TOPPIC_SEARCH_GRAPH_PROTEO_GRAPH_CACHE_HPP_
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <boost/thread/mutex.hpp>
+
+#include "common/base/mod.hpp"
+#include "search/graph/proteo_graph.hpp"
+
+namespace toppic {
+
+// A least recently used cache of proteoform graphs shared by the alignment
+// workers.
+//
+// A graph is keyed by its reference sequence and a key of the settings it
+// is built with (see geneSettingKey). Graphs are not changed after they are
+// built and GraphAlignSim only reads them, so the workers share them. The
+// memory of a graph is estimated from its distances, edges and
+// modification lists, and the least recently used graphs are dropped while
+// the total is above the budget. A budget of 0 disables the cache.
+class ProteoGraphCache {
+ public:
+  typedef std::function<ProteoGraphPtr()> BuildFunc;
+
+  explicit ProteoGraphCache(size_t max_byte_num): max_byte_num_(max_byte_num) {}
+
+  // Returns the cached graph or the one made by build. build is called
+  // without the lock, so workers missing the same key at the same time
+  // each build it and the first stored graph is kept.
+  ProteoGraphPtr get(const std::string & seq, const std::string & setting_key,
+                     const BuildFunc & build);
+
+  int getHitNum() {return hit_num_;}
+
+  int getMissNum() {return miss_num_;}
+
+  static std::string geneSettingKey(const ModPtrVec & fix_mod_ptr_vec,
+                                    const ModPtrVec & var_mod_ptr_vec,
+                                    const ModPtrVec & n_mod_ptr_vec,
+                                    int proteo_graph_gap, int var_ptm_in_gap,
+                                    int max_known_mods);
+
+  static size_t estimateByteNum(ProteoGraphPtr graph_ptr);
+
+ private:
+  struct Entry {
+    ProteoGraphPtr graph_ptr_;
+    size_t byte_num_;
+    std::list<std::string>::iterator lru_it_;
+  };
+
+  size_t max_byte_num_;
+
+  size_t byte_num_ = 0;
+
+  int hit_num_ = 0;
+
+  int miss_num_ = 0;
+
+  // keys, the most recently used first
+  std::list<std::string> lru_list_;
+
+  std::unordered_map<std::string, Entry> entry_map_;
+
+  boost::mutex mutex_;
+};
+
+typedef std::shared_ptr<ProteoGraphCache> ProteoGraphCachePtr;
+
+}  // namespace toppic
+
+#endif
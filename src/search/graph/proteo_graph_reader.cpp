@@ -13,6 +13,8 @@
 //limitations under the License.
 
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -41,34 +43,24 @@ ProteoGraphReader::ProteoGraphReader(const std::string &db_file_name,
           = std::make_shared<ProteoAnno>(fix_mod_ptr_vec, prot_mod_ptr_vec, var_mod_ptr_vec);
     }
 
-MassGraphPtr getMassGraphPtr(ProteoAnnoPtr proteo_anno_ptr, double convert_ratio) {
-  MassGraphPtr graph_ptr = std::make_shared<MassGraph>();
+ChainGraphPtr getChainGraphPtr(ProteoAnnoPtr proteo_anno_ptr, double convert_ratio) {
   int seq_len = proteo_anno_ptr->getLen();
-  for (int i = 0; i < seq_len + 1; i++) {
-    VertexInfo v(i);
-    add_vertex(v, *graph_ptr.get());
-  }
+  ChainGraphPtr graph_ptr = std::make_shared<ChainGraph>(seq_len + 1);
 
   for (int i = 0; i < seq_len; i++) {
-    Vertex v1, v2;
-    v1 = vertex(i, *graph_ptr.get());
-    v2 = vertex(i + 1, *graph_ptr.get());
     ResiduePtrVec res_ptr_vec = proteo_anno_ptr->getResiduePtrVec(i);
     std::vector<int> change_vec = proteo_anno_ptr->getChangeVec(i);
-    if (std::find(change_vec.begin(), change_vec.end(), AlterType::FIXED->getId()) != change_vec.end()) {
-      for (size_t j = 0; j < res_ptr_vec.size(); j++) {
-        if (change_vec[j] == AlterType::FIXED->getId()) {
-          EdgeInfo edge_info(res_ptr_vec[j], change_vec[j], convert_ratio);
-          add_edge(v1, v2, edge_info , *graph_ptr.get());
-        }
-      }
-    } else {
-      for (size_t j = 0; j < res_ptr_vec.size(); j++) {
-        EdgeInfo edge_info(res_ptr_vec[j], change_vec[j], convert_ratio);
-        add_edge(v1, v2, edge_info , *graph_ptr.get());
+    bool has_fixed = std::find(change_vec.begin(), change_vec.end(),
+                               AlterType::FIXED->getId()) != change_vec.end();
+    for (size_t j = 0; j < res_ptr_vec.size(); j++) {
+      if (has_fixed && change_vec[j] != AlterType::FIXED->getId()) {
+        continue;
       }
+      int int_mass = static_cast<int>(std::round(res_ptr_vec[j]->getMass() * convert_ratio));
+      graph_ptr->addEdge(i, int_mass, change_vec[j], res_ptr_vec[j]);
     }
   }
+  graph_ptr->build();
   return graph_ptr;
 }
 
@@ -18,6 +18,7 @@
 
 #include <string>
 
+#include "search/graph/chain_graph.hpp"
 #include "search/graph/graph.hpp"
 #include "search/graph/proteo_anno.hpp"
 #include "search/graph/proteo_graph.hpp"
@@ -54,7 +55,7 @@ class ProteoGraphReader {
   int var_ptm_in_gap_;
 };
 
-MassGraphPtr getMassGraphPtr(ProteoAnnoPtr proteo_anno_ptr, double convert_ratio);
+ChainGraphPtr getChainGraphPtr(ProteoAnnoPtr proteo_anno_ptr, double convert_ratio);
 
 } /* namespace toppic */
 
@@ -53,12 +53,11 @@ void SpecGraph::compSpecDistances(double convert_ratio) {
 
       int int_dist = std::round(dist * convert_ratio);
 
-      std::vector<std::pair<unsigned short, unsigned short>> empty_list;
-      Dist tmp = Dist(graph_ptr_, int_dist, i, j, empty_list);
+      Dist tmp = Dist(int_dist, i, j, ModListPool::EMPTY_ID);
       auto search = dist_set.find(tmp);
 
       if (search != dist_set.end()) {
-        search->pair_ij_.push_back(std::make_pair(std::pair<int, int>(i, j),empty_list));
+        search->pair_ij_.push_back(std::make_pair(std::pair<int, int>(i, j), ModListPool::EMPTY_ID));
       } else {
         dist_set.insert(tmp);
       }
@@ -12,77 +12,150 @@
 //See the License for the specific language governing permissions and
 //limitations under the License.
 
-
-#include <utility>
 #include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <utility>
 #include <vector>
-#include <set>
 
 #include "common/util/logger.hpp"
 #include "search/graph/spec_graph_sim.hpp"
+#include "search/graph/spec_graph_template.hpp"
 
 namespace toppic {
 
-SpecGraph_sim::SpecGraph_sim(std::vector<std::pair<PeakPtr, std::string>> peak_vec,
-                     MassGraphPtr graph_ptr, double convert_ratio) {
+void SpecDistTable::addPair(int dist, int i, int j) {
+  if (dists_.empty() || dists_.back() != dist) {
+    dists_.push_back(dist);
+    pair_begin_.push_back(pair_begin_.back());
+  }
+  pairs_.push_back(std::make_pair(i, j));
+  pair_begin_.back()++;
+}
+
+SpecGraph_sim::SpecGraph_sim(std::vector<std::pair<PeakPtr, SpecPeakType>> peak_vec,
+                     ChainGraphPtr graph_ptr, double convert_ratio) {
   peak_vec_ = peak_vec;
   graph_ptr_ = graph_ptr;
-  node_num_ = num_vertices(*graph_ptr.get());
-  pair_num_ = node_num_ * (node_num_ + 1) /2;
-  compSpecDistances(convert_ratio);
+  convert_ratio_ = convert_ratio;
 }
 
-int SpecGraph_sim::getVecIndex(int v1, int v2) {
-  int index =  (node_num_ + node_num_ - v1 + 1) * v1 /2  + (v2 - v1);
-  return index;
-}
+SpecGraph_sim::SpecGraph_sim(std::vector<std::pair<PeakPtr, SpecPeakType>> peak_vec,
+                             ChainGraphPtr graph_ptr, double convert_ratio,
+                             std::shared_ptr<SpecGraphTemplate> template_ptr,
+                             const std::vector<int> & peak_ids):
+    convert_ratio_(convert_ratio),
+    template_ptr_(template_ptr),
+    peak_ids_(peak_ids),
+    graph_ptr_(graph_ptr),
+    peak_vec_(peak_vec) {}
 
-int SpecGraph_sim::getPeakDist(int v1, int v2) {
-  int index = getVecIndex(v1, v2);
-  return peak_dists_[index];
+void SpecGraph_sim::compSpecDistances(int min_dist, int max_dist, SpecDistTable & dist_table) {
+  if (template_ptr_ != nullptr) {
+    compTemplateDistances(min_dist, max_dist, dist_table);
+    return;
+  }
+  dist_table.clear();
+  int peak_num = peak_vec_.size();
+  std::vector<double> pos(peak_num);
+  std::vector<int> order(peak_num);
+  for (int p = 0; p < peak_num; p++) {
+    pos[p] = peak_vec_[p].first->getPosition();
+    order[p] = p;
+  }
+  std::stable_sort(order.begin(), order.end(), [&pos](int a, int b) {return pos[a] < pos[b];});
+
+  // the peaks j with a rounded distance to i in [min_dist, max_dist] are in
+  // a window of the sorted peaks that moves with i
+  double low = (min_dist - 1) / convert_ratio_;
+  double high = (max_dist + 1) / convert_ratio_;
+  std::vector<std::tuple<int, int, int>> pairs;
+  int lo = 0, hi = 0;
+  for (int a = 0; a < peak_num; a++) {
+    int i = order[a];
+    while (lo < peak_num && pos[order[lo]] < pos[i] + low) lo++;
+    while (hi < peak_num && pos[order[hi]] <= pos[i] + high) hi++;
+    for (int b = lo; b < hi; b++) {
+      int j = order[b];
+      if (j <= i) continue;
+      int int_dist = std::round((pos[j] - pos[i]) * convert_ratio_);
+      if (int_dist >= min_dist && int_dist <= max_dist) {
+        pairs.push_back(std::make_tuple(int_dist, i, j));
+      }
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+  for (size_t p = 0; p < pairs.size(); p++) {
+    dist_table.addPair(std::get<0>(pairs[p]), std::get<1>(pairs[p]), std::get<2>(pairs[p]));
+  }
+  LOG_DEBUG("count " << pairs.size());
 }
 
-void SpecGraph_sim::compSpecDistances(double convert_ratio) {
-  std::set<Dist> dist_set;
-  int count = 0;
-  peak_dists_ = std::vector<int>(pair_num_, 0);
-  for (size_t i = 0; i < peak_vec_.size() - 1; i++) {
-    for (size_t j = i+1; j < peak_vec_.size(); j++) {
-      double dist = peak_vec_[j].first->getPosition() - peak_vec_[i].first->getPosition();
+void SpecGraph_sim::compTemplateDistances(int min_dist, int max_dist, SpecDistTable & dist_table) {
+  dist_table.clear();
+  int peak_num = peak_vec_.size();
+  int orig_num = template_ptr_->getOrigPeakNum();
+  std::vector<double> pos(peak_num);
+  for (int p = 0; p < peak_num; p++) {
+    pos[p] = peak_vec_[p].first->getPosition();
+  }
 
-      int int_dist = std::round(dist * convert_ratio);
-      //std::cout << "peak(" << i << ", " << j << "): " << dist << ", " << int_dist << std::endl;
-      std::vector<std::pair<unsigned short, unsigned short>> empty_list;
-      Dist tmp = Dist(graph_ptr_, int_dist, i, j, empty_list);
-      auto search = dist_set.find(tmp);
+  // kinds: 0 original, 1 reversed, 2 zero and 3 precursor. The vertices
+  // are sorted by mass, so the vertices of each kind are too.
+  const int kind_num = 4;
+  std::vector<int> kinds(peak_num);
+  std::vector<std::vector<int>> kind_vertices(kind_num);
+  std::vector<int> id_vertices(template_ptr_->getPeakNum(), -1);
+  for (int v = 0; v < peak_num; v++) {
+    int id = peak_ids_[v];
+    if (id == SpecGraphTemplate::ZERO_PEAK_ID) {
+      kinds[v] = 2;
+    } else if (id == SpecGraphTemplate::PREC_PEAK_ID) {
+      kinds[v] = 3;
+    } else {
+      kinds[v] = id < orig_num ? 0 : 1;
+      id_vertices[id] = v;
+    }
+    kind_vertices[kinds[v]].push_back(v);
+  }
 
-      if (search != dist_set.end()) {
-        search->pair_ij_.push_back(std::make_pair(std::pair<int, int>(i, j),empty_list));
-        //std::cout << "Dist " << search->dist_ << " is existed. ";
-        //for(int a = 0; a < search->pair_ij_.size(); a++){
-        //  std::cout << "(" << search->pair_ij_[a].first << ", " << search->pair_ij_[a].second << "), "; 
-        //}
-        //std::cout << std::endl;
-      } else {
-        dist_set.insert(tmp);
-        //std::cout << "not exist: peak(" << tmp.pair_ij_[0].first << ", " << tmp.pair_ij_[0].second << "): " << tmp.dist_ << std::endl;
+  std::vector<std::tuple<int, int, int>> pairs;
+  const std::vector<std::tuple<int, int, int>> & same_kind_pairs
+      = template_ptr_->getSameKindPairs(min_dist, max_dist);
+  for (size_t p = 0; p < same_kind_pairs.size(); p++) {
+    int i = id_vertices[std::get<1>(same_kind_pairs[p])];
+    int j = id_vertices[std::get<2>(same_kind_pairs[p])];
+    if (i >= 0 && j >= 0) {
+      pairs.push_back(std::make_tuple(std::get<0>(same_kind_pairs[p]), std::min(i, j), std::max(i, j)));
+    }
+  }
 
+  // pairs of different kinds, in a window of each kind that moves with i
+  double low = (min_dist - 1) / convert_ratio_;
+  double high = (max_dist + 1) / convert_ratio_;
+  std::vector<int> lo(kind_num, 0);
+  std::vector<int> hi(kind_num, 0);
+  for (int i = 0; i < peak_num; i++) {
+    for (int c = 0; c < kind_num; c++) {
+      const std::vector<int> & vertices = kind_vertices[c];
+      int num = vertices.size();
+      while (lo[c] < num && pos[vertices[lo[c]]] < pos[i] + low) lo[c]++;
+      while (hi[c] < num && pos[vertices[hi[c]]] <= pos[i] + high) hi[c]++;
+      if (c == kinds[i]) continue;
+      for (int b = lo[c]; b < hi[c]; b++) {
+        int j = vertices[b];
+        if (j <= i) continue;
+        int int_dist = std::round((pos[j] - pos[i]) * convert_ratio_);
+        if (int_dist >= min_dist && int_dist <= max_dist) {
+          pairs.push_back(std::make_tuple(int_dist, i, j));
+        }
       }
-
-      int index = getVecIndex(i, j);
-      peak_dists_[index] = int_dist;
-      count++;
     }
   }
-  LOG_DEBUG("count " << count);
-  std::copy(dist_set.begin(), dist_set.end(), std::back_inserter(dist_));
-  //for(int a = 0; a < dist_.size(); a++){
-  //  std::cout << "Dist: " << dist_[a].dist_ << ": ";
-  //  for(int b = 0; b < dist_[a].pair_ij_.size(); b++){
-  //    std::cout << "(" << dist_[a].pair_ij_[b].first << ", " << dist_[a].pair_ij_[b].second << "), "; 
-  //  }
-  //  std::cout << std::endl;
-  //}
+  std::sort(pairs.begin(), pairs.end());
+  for (size_t p = 0; p < pairs.size(); p++) {
+    dist_table.addPair(std::get<0>(pairs[p]), std::get<1>(pairs[p]), std::get<2>(pairs[p]));
+  }
 }
 
 }  // namespace toppic
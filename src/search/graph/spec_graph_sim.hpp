@@ -1,51 +1,87 @@
 #ifndef TOPPIC_SEARCH_GRAPH_SPEC_GRAPH_SIM_HPP_
 #define TOPPIC_SEARCH_GRAPH_SPEC_GRAPH_SIM_HPP_
 
+#include <utility>
 #include <vector>
 
 #include "ms/spec/prm_peak.hpp"
 #include "ms/spec/spectrum_set.hpp"
+#include "search/graph/chain_graph.hpp"
 #include "search/graph/dist.hpp"
 #include "search/graph/graph.hpp"
 
 namespace toppic {
 
-class SpecGraph_sim {
+// Distances between the peaks of a spectrum, grouped by integer distance
+// in increasing order. The peak pairs (i, j), i < j, of a group are in
+// (i, j) order.
+class SpecDistTable {
  public:
+  void clear() {dists_.clear(); pair_begin_.assign(1, 0); pairs_.clear();}
 
-  SpecGraph_sim(std::vector<std::pair<PeakPtr, std::string>> peak_vec,
-                MassGraphPtr mass_graph_ptr, double convert_ratio);
+  // pairs are added in (distance, i, j) order
+  void addPair(int dist, int i, int j);
 
-  MassGraphPtr getMassGraphPtr() {return graph_ptr_;}
+  int getGroupNum() {return dists_.size();}
 
-  DistVec getDistVec() {return dist_;}
+  int getDist(int g) {return dists_[g];}
 
-  std::pair<PeakPtr, std::string> getPeakPtr(int i) {return peak_vec_[i];}
+  const std::pair<int, int> * getPairs(int g) {return pairs_.data() + pair_begin_[g];}
 
-  const std::vector<std::pair<PeakPtr, std::string>>& getPeakPtrVec() {return peak_vec_;}
+  int getPairNum(int g) {return pair_begin_[g + 1] - pair_begin_[g];}
 
+ private:
+  std::vector<int> dists_;
 
-  
+  std::vector<int> pair_begin_ = std::vector<int>(1, 0);
 
-  int getPeakDist(int v1, int v2);
+  std::vector<std::pair<int, int>> pairs_;
+};
 
- private:
+class SpecGraphTemplate;
 
-  int node_num_;
+// Kind of a vertex of a spectrum graph: the peak of mass 0, a prm from an
+// N-terminal (original) or C-terminal (reversed) fragment, or the
+// precursor. The tolerance of a vertex depends on its kind.
+enum class SpecPeakType {ZERO, ORIGINAL, REVERSED, PREC};
+
+class SpecGraph_sim {
+ public:
 
-  int pair_num_;
+  SpecGraph_sim(std::vector<std::pair<PeakPtr, SpecPeakType>> peak_vec,
+                ChainGraphPtr graph_ptr, double convert_ratio);
 
-  std::vector<int> peak_dists_;
+  // a graph generated by template_ptr, peak_ids are the template peak ids
+  // of the vertices
+  SpecGraph_sim(std::vector<std::pair<PeakPtr, SpecPeakType>> peak_vec,
+                ChainGraphPtr graph_ptr, double convert_ratio,
+                std::shared_ptr<SpecGraphTemplate> template_ptr,
+                const std::vector<int> & peak_ids);
+
+  ChainGraphPtr getChainGraphPtr() {return graph_ptr_;}
+
+  // Computes the distances between the peaks in [min_dist, max_dist]
+  // into dist_table.
+  void compSpecDistances(int min_dist, int max_dist, SpecDistTable & dist_table);
+
+  std::pair<PeakPtr, SpecPeakType> getPeakPtr(int i) {return peak_vec_[i];}
+
+  const std::vector<std::pair<PeakPtr, SpecPeakType>>& getPeakPtrVec() {return peak_vec_;}
+
+ private:
+  // the distances between peaks of the same kind are taken from the
+  // template
+  void compTemplateDistances(int min_dist, int max_dist, SpecDistTable & dist_table);
 
-  MassGraphPtr graph_ptr_;
+  double convert_ratio_;
 
-  std::vector<std::pair<PeakPtr, std::string>> peak_vec_;
+  std::shared_ptr<SpecGraphTemplate> template_ptr_;
 
-  DistVec dist_;
+  std::vector<int> peak_ids_;
 
-  int getVecIndex(int v1, int v2);
+  ChainGraphPtr graph_ptr_;
 
-  void compSpecDistances(double convert_ratio);
+  std::vector<std::pair<PeakPtr, SpecPeakType>> peak_vec_;
 };
 
 typedef std::shared_ptr<SpecGraph_sim> SpecGraphPtr_sim;
@@ -53,4 +89,4 @@ typedef std::vector<SpecGraphPtr_sim> SpecGraphPtrVec_sim;
 
 }  // namespace toppic
 
-#endif /* SPEC_GRAPH_HPP_ */
\ No newline at end of file
+#endif /* SPEC_GRAPH_HPP_ */
@@ -0,0 +1,179 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string>
+#include <utility>
+
+#include "common/base/mass_constant.hpp"
+#include "search/graph/spec_graph_template.hpp"
+
+namespace toppic {
+
+const int SpecGraphTemplate::ZERO_PEAK_ID;
+const int SpecGraphTemplate::PREC_PEAK_ID;
+
+SpecGraphTemplate::SpecGraphTemplate(double prec_mono_mass, double min_mass,
+                                     double prec_peak_shift, double nterm_fix_shift,
+                                     double peak_min_mass, double convert_ratio):
+    prec_mono_mass_(prec_mono_mass),
+    min_mass_(min_mass),
+    prec_peak_shift_(prec_peak_shift),
+    nterm_fix_shift_(nterm_fix_shift),
+    peak_min_mass_(peak_min_mass),
+    convert_ratio_(convert_ratio) {}
+
+void SpecGraphTemplate::addPeak(double ori_mass, double inten, double n_shift, double c_shift) {
+  // as in prm_ms_factory::addTwoMasses_bottomupProton
+  orig_masses_.push_back(ori_mass - n_shift - mass_constant::getProtonMass());
+  orig_intens_.push_back(inten);
+  rev_bases_.push_back(ori_mass - c_shift);
+  rev_intens_.push_back(inten);
+}
+
+void SpecGraphTemplate::build() {
+  std::vector<int> order(orig_masses_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::vector<double> masses = orig_masses_;
+  std::vector<double> intens = orig_intens_;
+  std::stable_sort(order.begin(), order.end(),
+                   [&masses](int a, int b) {return masses[a] < masses[b];});
+  for (size_t k = 0; k < order.size(); k++) {
+    orig_masses_[k] = masses[order[k]];
+    orig_intens_[k] = intens[order[k]];
+  }
+
+  std::iota(order.begin(), order.end(), 0);
+  masses = rev_bases_;
+  intens = rev_intens_;
+  std::stable_sort(order.begin(), order.end(),
+                   [&masses](int a, int b) {return masses[a] > masses[b];});
+  for (size_t k = 0; k < order.size(); k++) {
+    rev_bases_[k] = masses[order[k]];
+    rev_intens_[k] = intens[order[k]];
+  }
+  pair_max_dist_ = -1;
+}
+
+SpecGraphPtr_sim SpecGraphTemplate::geneSpecGraph(double prec_error) {
+  double prec_mass = prec_mono_mass_ + prec_error;
+  double max_mass = prec_mass - min_mass_;
+  int orig_num = orig_masses_.size();
+
+  // (mass, peak id) of the peaks kept by prm_ms_factory::filterPeaks
+  std::vector<std::pair<double, int>> orig_peaks;
+  for (int k = 0; k < orig_num; k++) {
+    if (orig_masses_[k] >= min_mass_ && orig_masses_[k] <= max_mass) {
+      orig_peaks.push_back(std::make_pair(orig_masses_[k], k));
+    }
+  }
+  std::vector<std::pair<double, int>> rev_peaks;
+  for (size_t k = 0; k < rev_bases_.size(); k++) {
+    double mass = prec_mass - rev_bases_[k] + mass_constant::getProtonMass();
+    if (mass >= min_mass_ && mass <= max_mass) {
+      rev_peaks.push_back(std::make_pair(mass, orig_num + static_cast<int>(k)));
+    }
+  }
+
+  std::vector<std::pair<double, int>> peaks;
+  peaks.reserve(orig_peaks.size() + rev_peaks.size() + 2);
+  peaks.push_back(std::make_pair(0.0, ZERO_PEAK_ID));
+  auto cmp_mass = [](const std::pair<double, int> & a, const std::pair<double, int> & b) {
+    return a.first < b.first;
+  };
+  std::merge(orig_peaks.begin(), orig_peaks.end(), rev_peaks.begin(), rev_peaks.end(),
+             std::back_inserter(peaks), cmp_mass);
+  std::pair<double, int> prec_peak(prec_mass - prec_peak_shift_, PREC_PEAK_ID);
+  peaks.insert(std::upper_bound(peaks.begin() + 1, peaks.end(), prec_peak, cmp_mass), prec_peak);
+
+  // the zero peak is kept, the N-terminal fixed shift is removed from the
+  // others
+  std::vector<std::pair<PeakPtr, SpecPeakType>> peak_vec;
+  std::vector<int> peak_ids;
+  peak_vec.push_back(std::make_pair(std::make_shared<Peak>(0, 0), SpecPeakType::ZERO));
+  peak_ids.push_back(ZERO_PEAK_ID);
+  for (size_t p = 1; p < peaks.size(); p++) {
+    double mass = peaks[p].first - nterm_fix_shift_;
+    if (mass <= peak_min_mass_) {
+      continue;
+    }
+    int id = peaks[p].second;
+    double inten = 0;
+    SpecPeakType type = SpecPeakType::PREC;
+    if (id >= orig_num) {
+      inten = rev_intens_[id - orig_num];
+      type = SpecPeakType::REVERSED;
+    } else if (id >= 0) {
+      inten = orig_intens_[id];
+      type = SpecPeakType::ORIGINAL;
+    }
+    peak_vec.push_back(std::make_pair(std::make_shared<Peak>(mass, inten), type));
+    peak_ids.push_back(id);
+  }
+
+  // vertex 0 is mass 0, followed by one vertex per prm
+  ChainGraphPtr graph_ptr = std::make_shared<ChainGraph>(peak_vec.size());
+  for (size_t i = 1; i < peak_vec.size(); i++) {
+    double dist = peak_vec[i].first->getPosition() - peak_vec[i - 1].first->getPosition();
+    int int_dist = static_cast<int>(std::round(dist * convert_ratio_));
+    graph_ptr->addEdge(i - 1, int_dist, -1, nullptr);
+  }
+  graph_ptr->build();
+  return std::make_shared<SpecGraph_sim>(peak_vec, graph_ptr, convert_ratio_,
+                                         shared_from_this(), peak_ids);
+}
+
+void SpecGraphTemplate::addSameKindPairs(const std::vector<double> & pos, int id_base,
+                                         int min_dist, int max_dist) {
+  double low = (min_dist - 1) / convert_ratio_;
+  double high = (max_dist + 1) / convert_ratio_;
+  int peak_num = pos.size();
+  int lo = 0, hi = 0;
+  for (int a = 0; a < peak_num; a++) {
+    while (lo < peak_num && pos[lo] < pos[a] + low) lo++;
+    while (hi < peak_num && pos[hi] <= pos[a] + high) hi++;
+    for (int b = std::max(lo, a + 1); b < hi; b++) {
+      int int_dist = std::round((pos[b] - pos[a]) * convert_ratio_);
+      if (int_dist >= min_dist && int_dist <= max_dist) {
+        same_kind_pairs_.push_back(std::make_tuple(int_dist, id_base + a, id_base + b));
+      }
+    }
+  }
+}
+
+const std::vector<std::tuple<int, int, int>> & SpecGraphTemplate::getSameKindPairs(int min_dist,
+                                                                                    int max_dist) {
+  if (min_dist == pair_min_dist_ && max_dist == pair_max_dist_) {
+    return same_kind_pairs_;
+  }
+  same_kind_pairs_.clear();
+  // positions in the spectrum graph, for the reversed peaks at offset 0
+  std::vector<double> pos(orig_masses_.size());
+  for (size_t k = 0; k < orig_masses_.size(); k++) {
+    pos[k] = orig_masses_[k] - nterm_fix_shift_;
+  }
+  addSameKindPairs(pos, 0, min_dist, max_dist);
+  pos.resize(rev_bases_.size());
+  for (size_t k = 0; k < rev_bases_.size(); k++) {
+    pos[k] = prec_mono_mass_ - rev_bases_[k] + mass_constant::getProtonMass() - nterm_fix_shift_;
+  }
+  addSameKindPairs(pos, orig_masses_.size(), min_dist, max_dist);
+  pair_min_dist_ = min_dist;
+  pair_max_dist_ = max_dist;
+  return same_kind_pairs_;
+}
+
+}  // namespace toppic
@@ -0,0 +1,105 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef TOPPIC_SEARCH_GRAPH_SPEC_GRAPH_TEMPLATE_HPP_
+#define TOPPIC_SEARCH_GRAPH_SPEC_GRAPH_TEMPLATE_HPP_
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "search/graph/spec_graph_sim.hpp"
+
+namespace toppic {
+
+// The prm peaks of a spectrum, kept apart from the precursor mass, so that
+// the spectrum graphs of several precursor mass offsets are generated
+// without rebuilding the spectrum.
+//
+// The masses of the original peaks do not depend on the precursor mass.
+// A reversed peak has mass prec_mass - base + proton, so it moves with the
+// offset, and all reversed peaks move together. Both kinds are sorted once.
+// geneSpecGraph() merges them for one offset, applies the same filters as
+// prm_ms_factory::geneMsTwoPtr and the N-terminal fixed shift, and builds
+// the graph. Distances between two peaks of the same kind do not change
+// with the offset. They are computed once by getSameKindPairs(), so
+// compSpecDistances() only computes the distances between peaks of
+// different kinds for each offset.
+class SpecGraphTemplate : public std::enable_shared_from_this<SpecGraphTemplate> {
+ public:
+  // peak id of the zero and precursor peaks
+  static const int ZERO_PEAK_ID = -1;
+  static const int PREC_PEAK_ID = -2;
+
+  // min_mass is the minimum prm mass of SpPara and prec_peak_shift the
+  // shift of the precursor ion type.
+  SpecGraphTemplate(double prec_mono_mass, double min_mass, double prec_peak_shift,
+                    double nterm_fix_shift, double peak_min_mass, double convert_ratio);
+
+  // ori_mass is the mass of a deconvoluted peak, n_shift and c_shift are
+  // the shifts of the activation of its spectrum.
+  void addPeak(double ori_mass, double inten, double n_shift, double c_shift);
+
+  // sorts the peaks, called after all peaks are added
+  void build();
+
+  SpecGraphPtr_sim geneSpecGraph(double prec_error);
+
+  // Peaks [0, getOrigPeakNum()) are original and the others reversed.
+  int getOrigPeakNum() {return orig_masses_.size();}
+
+  int getPeakNum() {return orig_masses_.size() + rev_bases_.size();}
+
+  // Pairs (distance, a, b) of peaks of the same kind with a rounded
+  // distance in [min_dist, max_dist], where peak a is lighter than peak b.
+  // Cached for the last cutoffs.
+  const std::vector<std::tuple<int, int, int>> & getSameKindPairs(int min_dist, int max_dist);
+
+ private:
+  void addSameKindPairs(const std::vector<double> & pos, int id_base, int min_dist, int max_dist);
+
+  double prec_mono_mass_;
+
+  double min_mass_;
+
+  double prec_peak_shift_;
+
+  double nterm_fix_shift_;
+
+  double peak_min_mass_;
+
+  double convert_ratio_;
+
+  // masses of the original peaks, in increasing order
+  std::vector<double> orig_masses_;
+
+  std::vector<double> orig_intens_;
+
+  // ori_mass - c_shift of the reversed peaks, in decreasing order
+  std::vector<double> rev_bases_;
+
+  std::vector<double> rev_intens_;
+
+  int pair_min_dist_ = 0;
+
+  int pair_max_dist_ = -1;
+
+  std::vector<std::tuple<int, int, int>> same_kind_pairs_;
+};
+
+typedef std::shared_ptr<SpecGraphTemplate> SpecGraphTemplatePtr;
+
+}  // namespace toppic
+
+#endif
@@ -0,0 +1,195 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "common/util/logger.hpp"
+#include "search/graphalign/graph_abund_search.hpp"
+
+namespace toppic {
+
+GraphAbundSearch::GraphAbundSearch(const std::string & mode, double coarse_step,
+                                   double tolerance, double min_abund, double max_abund):
+    mode_(mode),
+    coarse_step_(coarse_step),
+    tolerance_(tolerance),
+    min_abund_(min_abund),
+    max_abund_(max_abund) {
+      if (coarse_step_ < 1) coarse_step_ = 1;
+      if (tolerance_ <= 0) tolerance_ = 1;
+    }
+
+bool GraphAbundSearch::isValidMode(const std::string & mode) {
+  return mode == "GRID" || mode == "COARSE" || mode == "GOLDEN";
+}
+
+std::pair<double, double> GraphAbundSearch::clamp(double abund_a, double abund_b) {
+  abund_a = std::min(std::max(abund_a, min_abund_), max_abund_);
+  abund_b = std::min(std::max(abund_b, min_abund_), max_abund_);
+  return std::make_pair(abund_a, abund_b);
+}
+
+void GraphAbundSearch::evalBatch(const std::vector<std::pair<double, double>> & points) {
+  std::vector<std::pair<double, double>> new_points;
+  std::map<std::pair<double, double>, double> batch;
+  for (size_t i = 0; i < points.size(); i++) {
+    std::pair<double, double> key = clamp(points[i].first, points[i].second);
+    if (cache_.find(key) == cache_.end() && batch.find(key) == batch.end()) {
+      batch[key] = 0;
+      new_points.push_back(key);
+    }
+  }
+  if (new_points.empty()) {
+    return;
+  }
+  std::vector<double> errors = eval_func_(new_points);
+  eval_num_ += new_points.size();
+  for (size_t i = 0; i < new_points.size(); i++) {
+    cache_[new_points[i]] = errors[i];
+    update(new_points[i].first, new_points[i].second, errors[i]);
+  }
+}
+
+double GraphAbundSearch::eval(double abund_a, double abund_b) {
+  std::pair<double, double> key = clamp(abund_a, abund_b);
+  evalBatch(std::vector<std::pair<double, double>>(1, key));
+  return cache_[key];
+}
+
+// The first point with the minimum error is kept, as in the grid search.
+void GraphAbundSearch::update(double abund_a, double abund_b, double error) {
+  if (!has_best_ || error < best_.error_) {
+    best_ = GraphAbundPoint(abund_a, abund_b, error);
+    has_best_ = true;
+  }
+}
+
+void GraphAbundSearch::gridSearch(double step) {
+  std::vector<double> values;
+  for (double v = min_abund_; v < max_abund_; v += step) {
+    values.push_back(v);
+  }
+  values.push_back(max_abund_);
+  std::vector<std::pair<double, double>> points;
+  for (size_t i = 0; i < values.size(); i++) {
+    for (size_t j = 0; j < values.size(); j++) {
+      points.push_back(std::make_pair(values[i], values[j]));
+    }
+  }
+  evalBatch(points);
+}
+
+void GraphAbundSearch::localRefine() {
+  double step = coarse_step_ / 2;
+  while (step >= tolerance_) {
+    GraphAbundPoint center = best_;
+    std::vector<std::pair<double, double>> points;
+    for (int da = -1; da <= 1; da++) {
+      for (int db = -1; db <= 1; db++) {
+        if (da == 0 && db == 0) continue;
+        points.push_back(std::make_pair(center.abund_a_ + da * step, center.abund_b_ + db * step));
+      }
+    }
+    evalBatch(points);
+    // halve the step only when the center is still the best point
+    if (best_.abund_a_ == center.abund_a_ && best_.abund_b_ == center.abund_b_) {
+      step = step / 2;
+    }
+  }
+}
+
+double GraphAbundSearch::goldenSection(double lo, double hi, double tole,
+                                       std::function<double(double)> func) {
+  const double inv_phi = (std::sqrt(5.0) - 1) / 2;
+  double x1 = hi - inv_phi * (hi - lo);
+  double x2 = lo + inv_phi * (hi - lo);
+  double f1 = func(x1);
+  double f2 = func(x2);
+  while (hi - lo > tole) {
+    if (f1 <= f2) {
+      hi = x2;
+      x2 = x1;
+      f2 = f1;
+      x1 = hi - inv_phi * (hi - lo);
+      f1 = func(x1);
+    } else {
+      lo = x1;
+      x1 = x2;
+      f1 = f2;
+      x2 = lo + inv_phi * (hi - lo);
+      f2 = func(x2);
+    }
+  }
+  return std::min(f1, f2);
+}
+
+double GraphAbundSearch::minOverTotal(double ratio) {
+  // a = ratio * total and b = (1 - ratio) * total must stay in range
+  double lo = std::max(min_abund_ / ratio, min_abund_ / (1 - ratio));
+  double hi = std::min(max_abund_ / ratio, max_abund_ / (1 - ratio));
+  if (hi <= lo) {
+    return eval(ratio * lo, (1 - ratio) * lo);
+  }
+  return goldenSection(lo, hi, tolerance_, [this, ratio](double total) {
+    return eval(ratio * total, (1 - ratio) * total);
+  });
+}
+
+void GraphAbundSearch::goldenSearch() {
+  double min_ratio = min_abund_ / (min_abund_ + max_abund_);
+  double max_ratio = max_abund_ / (min_abund_ + max_abund_);
+  double ratio_step = coarse_step_ / (min_abund_ + max_abund_);
+  double ratio_tole = tolerance_ / (min_abund_ + max_abund_);
+
+  // bracket the best ratio on a coarse grid
+  double best_ratio = min_ratio;
+  double best_error = 0;
+  bool first = true;
+  for (double r = min_ratio; r <= max_ratio + 1e-12; r += ratio_step) {
+    double error = minOverTotal(std::min(r, max_ratio));
+    if (first || error < best_error) {
+      best_ratio = std::min(r, max_ratio);
+      best_error = error;
+      first = false;
+    }
+  }
+  double lo = std::max(min_ratio, best_ratio - ratio_step);
+  double hi = std::min(max_ratio, best_ratio + ratio_step);
+  goldenSection(lo, hi, ratio_tole, [this](double ratio) {
+    return minOverTotal(ratio);
+  });
+}
+
+GraphAbundPoint GraphAbundSearch::search(GraphAbundEvalFunc eval_func) {
+  eval_func_ = eval_func;
+  cache_.clear();
+  has_best_ = false;
+  eval_num_ = 0;
+  if (mode_ == "COARSE") {
+    gridSearch(coarse_step_);
+    localRefine();
+  } else if (mode_ == "GOLDEN") {
+    goldenSearch();
+  } else {
+    if (mode_ != "GRID") {
+      LOG_ERROR("Unknown abundance search mode " << mode_ << ", the grid search is used.");
+    }
+    gridSearch(1);
+  }
+  return best_;
+}
+
+}  // namespace toppic
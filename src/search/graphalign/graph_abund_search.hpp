@@ -0,0 +1,115 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ABUND_SEARCH_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ABUND_SEARCH_HPP_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace toppic {
+
+// Abundances are given in percent of the maximum peak intensity, so
+// (a, b) = (10, 20) means q1 = 0.1 * max_inten and q2 = 0.2 * max_inten.
+class GraphAbundPoint {
+ public:
+  GraphAbundPoint() {}
+
+  GraphAbundPoint(double abund_a, double abund_b, double error):
+      abund_a_(abund_a),
+      abund_b_(abund_b),
+      error_(error) {}
+
+  double abund_a_ = 0;
+
+  double abund_b_ = 0;
+
+  double error_ = 0;
+};
+
+// Returns the two-path errors for a batch of abundance pairs.
+typedef std::function<std::vector<double>(const std::vector<std::pair<double, double>> &)> GraphAbundEvalFunc;
+
+// Searches the abundance pair with the minimum two-path error.
+//   GRID:   every integer pair in [min_abund, max_abund]^2, the reference mode.
+//   COARSE: a grid with step coarse_step, then a local pattern search
+//           whose step is halved until it is smaller than tolerance.
+//   GOLDEN: golden-section search over the ratio a / (a + b); for each
+//           ratio the total a + b is found by a nested golden-section
+//           search. The ratio is first bracketed on a coarse grid.
+// Points that do not depend on each other, such as a grid or the
+// neighbors of a point, are passed to the evaluation function together.
+class GraphAbundSearch {
+ public:
+  GraphAbundSearch(const std::string & mode, double coarse_step, double tolerance,
+                   double min_abund = 1, double max_abund = 99);
+
+  GraphAbundPoint search(GraphAbundEvalFunc eval_func);
+
+  int getEvalNum() {return eval_num_;}
+
+  static bool isValidMode(const std::string & mode);
+
+ private:
+  std::pair<double, double> clamp(double abund_a, double abund_b);
+
+  void evalBatch(const std::vector<std::pair<double, double>> & points);
+
+  double eval(double abund_a, double abund_b);
+
+  void update(double abund_a, double abund_b, double error);
+
+  void gridSearch(double step);
+
+  void localRefine();
+
+  double goldenSection(double lo, double hi, double tole,
+                       std::function<double(double)> func);
+
+  double minOverTotal(double ratio);
+
+  void goldenSearch();
+
+  std::string mode_;
+
+  double coarse_step_;
+
+  double tolerance_;
+
+  double min_abund_;
+
+  double max_abund_;
+
+  GraphAbundEvalFunc eval_func_;
+
+  // evaluated points, so that a point is never computed twice
+  std::map<std::pair<double, double>, double> cache_;
+
+  GraphAbundPoint best_;
+
+  bool has_best_ = false;
+
+  int eval_num_ = 0;
+};
+
+typedef std::shared_ptr<GraphAbundSearch> GraphAbundSearchPtr;
+
+}  // namespace toppic
+
+#endif
@@ -60,6 +60,7 @@ GraphAlign::GraphAlign(GraphAlignMngPtr mng_ptr,
   mng_ptr_ = mng_ptr;
   proteo_graph_ptr_ = proteo_graph_ptr;
   spec_graph_ptr_ = spec_graph_ptr;
+  mod_list_pool_ptr_ = proteo_graph_ptr_->getModListPoolPtr();
 
   dist_vec_ = proteo_graph_ptr_->getDistVec2D();
   spec_dist_ = spec_graph_ptr_->getDistVec();
@@ -79,9 +80,9 @@ GraphAlign::GraphAlign(GraphAlignMngPtr mng_ptr,
     std::sort(dist_vec_[i].begin(), dist_vec_[i].end(), distVecUp);
   }
 
-  pg_ = proteo_graph_ptr_->getMassGraphPtr();
+  pg_ = proteo_graph_ptr_->getChainGraphPtr();
   sg_ = spec_graph_ptr_->getMassGraphPtr();
-  proteo_ver_num_ = num_vertices(*pg_.get());
+  proteo_ver_num_ = pg_->getVertexNum();
   spec_ver_num_ = num_vertices(*sg_.get());
   LOG_DEBUG("Graph constructor end");
 }
@@ -1055,9 +1056,9 @@ void GraphAlign::getNewConsPair() {
   //std::cout << "maxDelta: " << maxDelta << std::endl;
   //int totalTole = 0;
 
-  std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,std::vector<std::pair<unsigned short,unsigned short>>>>>> empty_vec;
+  std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,ModListId>>>> empty_vec;
   for (int i = 0; i < proteo_ver_num_; i++) {
-    std::vector<std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,std::vector<std::pair<unsigned short,unsigned short>>>>>>> empty_vec_2d;
+    std::vector<std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,ModListId>>>>> empty_vec_2d;
     for (int j = 0; j < spec_ver_num_; j++) {
       empty_vec_2d.push_back(empty_vec);
     }
@@ -1316,10 +1317,10 @@ void GraphAlign::addToNewConsistentPairs(int mass, const std::vector<std::pair<i
 */
 
 
-void GraphAlign::addToNewConsistentPairs(int mass, const std::vector<std::pair<std::pair<int, int>, std::vector<std::pair<unsigned short,unsigned short>>>> & sp_pair_ij,
-                                      const std::vector<std::pair<std::pair<int, int>, std::vector<std::pair<unsigned short,unsigned short>>>> & pg_pair_ij) {
+void GraphAlign::addToNewConsistentPairs(int mass, const std::vector<std::pair<std::pair<int, int>, ModListId>> & sp_pair_ij,
+                                      const std::vector<std::pair<std::pair<int, int>, ModListId>> & pg_pair_ij) {
   
-  std::vector<std::pair<std::pair<unsigned short, unsigned short>,std::vector<std::pair<unsigned short,unsigned short>>>> prePairList;
+  std::vector<std::pair<std::pair<unsigned short, unsigned short>,ModListId>> prePairList;
   for (size_t k = 0; k < pg_pair_ij.size(); k++) {
     for (size_t sp = 0; sp < sp_pair_ij.size(); sp++) {
       prePairList.clear();
@@ -1767,7 +1768,7 @@ void GraphAlign:: computeT_v2(bool case1, double ptm_mass){ //whole spectrum and
       }
     }
     new_cons_pairs_[i].clear();
-    std::vector<std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,std::vector<std::pair<unsigned short,unsigned short>>>>>>>().swap(new_cons_pairs_[i]);
+    std::vector<std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,ModListId>>>>>().swap(new_cons_pairs_[i]);
   }
   new_cons_pairs_.clear();
   NewConsPairs().swap(new_cons_pairs_);
@@ -2019,7 +2020,7 @@ void GraphAlign::quantification_case1(std::vector<std::tuple<int, int, int>> end
         Vertex_AGraph target = boost::target(edge_next, *alignGraph_ptr);
         std::cout << "   Edge " << index2+1 << ": to T(" << (*alignGraph_ptr)[target].i_ << ", " << (*alignGraph_ptr)[target].j_ << ", " << (*alignGraph_ptr)[target].k_ << ") = " << (*alignGraph_ptr)[target].T_ << "; | ";
         std::cout << "Exact mass is " << (*alignGraph_ptr)[edge_next].exactMass_ << "; | Black mass is " << (*alignGraph_ptr)[edge_next].blackMass_ << "; | Mod infor are ";
-        auto modInfo = (*alignGraph_ptr)[edge_next].ModInfo_;
+        auto modInfo = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[edge_next].mod_list_id_);
         int sum = 0;
         for(int index3 = 0; index3 < modInfo.size(); index3++){
           std::cout << "[" << modInfo[index3].first << ", " << modInfo[index3].second << "], ";
@@ -2107,8 +2108,8 @@ void GraphAlign::quantification_case1(std::vector<std::tuple<int, int, int>> end
                   info2.clear();
                   auto a = edge(prePath.first.second, endPath.first.second, *(alignGraph_ptr.get()));
                   auto b = edge(prePath.second.second, endPath.second.second, *(alignGraph_ptr.get()));
-                  info1 = (*alignGraph_ptr)[a.first].ModInfo_;
-                  info2 = (*alignGraph_ptr)[b.first].ModInfo_;
+                  info1 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[a.first].mod_list_id_);
+                  info2 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[b.first].mod_list_id_);
                   //std::cout << "666" << std::endl;
                   resultPath.emplace_back(std::make_pair(std::make_tuple((*alignGraph_ptr)[prePath.first.second].i_, (*alignGraph_ptr)[prePath.first.second].j_, (*alignGraph_ptr)[prePath.first.second].k_, info1), std::make_tuple((*alignGraph_ptr)[prePath.second.second].i_, (*alignGraph_ptr)[prePath.second.second].j_, (*alignGraph_ptr)[prePath.second.second].k_, info2)));
                   //std::cout << "777" << std::endl;
@@ -2138,8 +2139,8 @@ void GraphAlign::quantification_case1(std::vector<std::tuple<int, int, int>> end
                     auto a = edge(prePath.first.second, endPath.first.second, *(alignGraph_ptr.get()));
                     auto b = edge(prePath.second.second, endPath.second.second, *(alignGraph_ptr.get()));
                     //std::cout << a.second << ", " << b.second << std::endl;
-                    info1 = (*alignGraph_ptr)[a.first].ModInfo_;
-                    info2 = (*alignGraph_ptr)[b.first].ModInfo_;
+                    info1 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[a.first].mod_list_id_);
+                    info2 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[b.first].mod_list_id_);
                     //std::cout << "666" << std::endl;
                     resultPath.emplace_back(std::make_pair(std::make_tuple((*alignGraph_ptr)[prePath.first.second].i_, (*alignGraph_ptr)[prePath.first.second].j_, (*alignGraph_ptr)[prePath.first.second].k_, info1), std::make_tuple((*alignGraph_ptr)[prePath.second.second].i_, (*alignGraph_ptr)[prePath.second.second].j_, (*alignGraph_ptr)[prePath.second.second].k_, info2)));
                     //std::cout << "777" << std::endl;
@@ -2293,7 +2294,7 @@ void GraphAlign::quantification_case2(std::vector<std::tuple<int, int, int>> end
           Vertex_AGraph target = boost::target(edge_next, *alignGraph_ptr);
           std::cout << "   Edge " << index2+1 << ": to T(" << (*alignGraph_ptr)[target].i_ << ", " << (*alignGraph_ptr)[target].j_ << ", " << (*alignGraph_ptr)[target].k_ << ") = " << (*alignGraph_ptr)[target].T_ << "; | ";
           std::cout << "Exact mass is " << (*alignGraph_ptr)[edge_next].exactMass_ << "; | Black mass is " << (*alignGraph_ptr)[edge_next].blackMass_ << "; | Mod infor are ";
-          auto modInfo = (*alignGraph_ptr)[edge_next].ModInfo_;
+          auto modInfo = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[edge_next].mod_list_id_);
           int sum = 0;
           for(int index3 = 0; index3 < modInfo.size(); index3++){
             std::cout << "[" << modInfo[index3].first << ", " << modInfo[index3].second << "], ";
@@ -2650,8 +2651,8 @@ std::pair<std::vector<std::pair<std::tuple<int, int, int, std::vector<std::pair<
     auto a = edge(prePath.first.second, endPath.first.second, *(alignGraph_ptr.get()));
     auto b = edge(prePath.second.second, endPath.second.second, *(alignGraph_ptr.get()));
     //std::cout << a.second << ", " << b.second << std::endl;
-    info1 = (*alignGraph_ptr)[a.first].ModInfo_;
-    info2 = (*alignGraph_ptr)[b.first].ModInfo_;
+    info1 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[a.first].mod_list_id_);
+    info2 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[b.first].mod_list_id_);
     //std::cout << "666" << std::endl;
     returnValue.emplace_back(std::make_pair(std::make_tuple((*alignGraph_ptr)[prePath.first.second].i_, (*alignGraph_ptr)[prePath.first.second].j_, (*alignGraph_ptr)[prePath.first.second].k_, info1), std::make_tuple((*alignGraph_ptr)[prePath.second.second].i_, (*alignGraph_ptr)[prePath.second.second].j_, (*alignGraph_ptr)[prePath.second.second].k_, info2)));
     //std::cout << "777" << std::endl;
@@ -2686,8 +2687,8 @@ std::pair<std::vector<std::pair<std::tuple<int, int, int, std::vector<std::pair<
     auto a = edge(preNode.second, tempNode, *(alignGraph_ptr.get()));
     //auto b = edge(prePath.second.second, endPath.second.second, *(alignGraph_ptr.get()));
     //std::cout << a.second << ", " << b.second << std::endl;
-    info1 = (*alignGraph_ptr)[a.first].ModInfo_;
-    //info2 = (*alignGraph_ptr)[b.first].ModInfo_;
+    info1 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[a.first].mod_list_id_);
+    //info2 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[b.first].mod_list_id_);
     singlePath.emplace_back((*alignGraph_ptr)[preNode.second].i_, (*alignGraph_ptr)[preNode.second].j_, (*alignGraph_ptr)[preNode.second].k_, info1);
     tempNode = preNode.second;
     temp = preNode.first;
@@ -2970,7 +2971,7 @@ void GraphAlign::add_all_info(int i, int j, int k,
                               std::vector<std::vector<std::vector<std::vector<prePosition>>>> E, 
                               const AlignmentGraphPtr &alignGraph_ptr,
                               const std::shared_ptr<std::unordered_map<std::tuple<int, int, int>, int, toppic::hashKey_tuple>> &vertexMapPtr,
-                              int ori_index, int exactMass, int blackMass, std::vector<std::pair<unsigned short, unsigned short>> modInfo){
+                              int ori_index, int exactMass, int blackMass, ModListId modInfo){
   int v_index;
   if (vertexMapPtr->find(std::make_tuple(i, j, k)) == vertexMapPtr->end())
   {
@@ -3150,19 +3151,13 @@ void GraphAlign::findModMass(short prot_start){
   int negDiffMass = 0;
   MaxRed.push_back(std::make_pair(posDiffMass,negDiffMass));
 
-  Vertex v_start = *boost::vertices(*pg_).first;
-  Vertex v_next = v_start;
   for(int i = 0; i < proteo_ver_num_ - 1; i++){
     if(i >= prot_start){
-      std::pair<out_edge_iter, out_edge_iter> outEdge = boost::out_edges(v_next, *pg_);
-      out_edge_iter edgeIter_start = outEdge.first;
-      out_edge_iter edgeIter_next = edgeIter_start;
-      size_t outEdgeNum = boost::out_degree(v_next, *pg_);
-      Edge edge_next;
+      int edgeBegin = pg_->getEdgeBegin(i);
+      size_t outEdgeNum = pg_->getEdgeEnd(i) - edgeBegin;
 
       if(outEdgeNum == 1){
-        edge_next = *edgeIter_next;
-        int edgeMass = (*pg_)[edge_next].int_mass_;
+        int edgeMass = pg_->getEdge(edgeBegin).int_mass_;
         int currentMass = originalMass[originalMass.size()-1] + edgeMass;
         originalMass.push_back(currentMass);
         MaxRed.push_back(std::make_pair(posDiffMass,negDiffMass));
@@ -3171,9 +3166,9 @@ void GraphAlign::findModMass(short prot_start){
         int blackMass;
         std::vector<int> redMass;
         for(size_t j = 0; j < outEdgeNum; j++){     
-          edge_next = *edgeIter_next;
-          int edgeMass = (*pg_)[edge_next].int_mass_;
-          PtmPtr ptm = (*pg_)[edge_next].res_ptr_->getPtmPtr();
+          const ChainEdge & edge_next = pg_->getEdge(edgeBegin + j);
+          int edgeMass = edge_next.int_mass_;
+          PtmPtr ptm = pg_->getResiduePtr(edge_next.res_idx_)->getPtmPtr();
           std::string name = ptm->getName();
           if(name == "No PTM") {
             blackMass = edgeMass;
@@ -3183,7 +3178,6 @@ void GraphAlign::findModMass(short prot_start){
           else{
             redMass.push_back(edgeMass);
           }
-          ++edgeIter_next;
         }
         for(auto redIter = redMass.begin(); redIter != redMass.end(); redIter++){
           int diffMass = *redIter - blackMass;
@@ -3193,7 +3187,6 @@ void GraphAlign::findModMass(short prot_start){
         MaxRed.push_back(std::make_pair(posDiffMass,negDiffMass));      
       }
     }
-    ++v_next;
   }
 
 }
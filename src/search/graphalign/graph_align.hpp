@@ -29,7 +29,7 @@ namespace toppic {
 
 
 typedef std::vector<std::vector<std::vector<std::vector<std::pair<int, int>>>>> ConsistentPairs;
-typedef std::vector<std::vector<std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,std::vector<std::pair<unsigned short,unsigned short>>>>>>>> NewConsPairs;
+typedef std::vector<std::vector<std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,ModListId>>>>>> NewConsPairs;
 typedef std::pair<std::pair<int,Vertex_AGraph>,std::pair<int,Vertex_AGraph>> PrePathInfo;
 
 struct hashKey_tuple{
@@ -44,7 +44,7 @@ struct hashKey_tuple{
 };
 
 
-typedef std::pair<std::pair<unsigned short,unsigned short>,std::tuple<short int, unsigned int, std::vector<std::pair<unsigned short,unsigned short>>>> prePosition;
+typedef std::pair<std::pair<unsigned short,unsigned short>,std::tuple<short int, unsigned int, ModListId>> prePosition;
 
 
 
@@ -75,7 +75,9 @@ class GraphAlign {
 
   ProteoGraphPtr proteo_graph_ptr_;
 
-  MassGraphPtr pg_;
+  ModListPoolPtr mod_list_pool_ptr_;
+
+  ChainGraphPtr pg_;
 
   int proteo_ver_num_;
 
@@ -151,8 +153,8 @@ class GraphAlign {
   //void getNewConsPairOri();
 
 
-  void addToNewConsistentPairs(int m, const std::vector<std::pair<std::pair<int, int>, std::vector<std::pair<unsigned short,unsigned short>>>> & sp_pair_ij,
-                            const std::vector<std::pair<std::pair<int, int>, std::vector<std::pair<unsigned short,unsigned short>>>> & pg_pair_ij);
+  void addToNewConsistentPairs(int m, const std::vector<std::pair<std::pair<int, int>, ModListId>> & sp_pair_ij,
+                            const std::vector<std::pair<std::pair<int, int>, ModListId>> & pg_pair_ij);
 
 
   void getDelta();
@@ -186,7 +188,7 @@ class GraphAlign {
 //                  std::vector<std::vector<std::vector<std::vector<prePosition>>>> E,
 //                  AlignmentGraphPtr alignGraph_ptr,
 //                  std::shared_ptr<std::unordered_map<std::tuple<int, int, int>, int, toppic::hashKey_tuple>> vertexMapPtr,
-//                  int ori_index, int exactMass, int blackMass, std::vector<std::pair<unsigned short, unsigned short>> modInfo);
+//                  int ori_index, int exactMass, int blackMass, ModListId modInfo);
 
   std::vector<std::vector<std::pair<double, std::pair<int, Vertex_AGraph>>>> buildAdditionPath(AlignmentGraphPtr alignGraph_ptr, int T1, int T2, Vertex_AGraph beginNode1, std::vector<std::vector<Vertex_AGraph>> layers1, double a_inten);
 
@@ -206,7 +208,7 @@ class GraphAlign {
                     const AlignmentGraphPtr &alignGraph_ptr,
                     const std::shared_ptr<std::unordered_map<std::tuple<int, int, int>, int, toppic::hashKey_tuple>> &vertexMapPtr,
                     int ori_index, int exactMass, int blackMass,
-                    std::vector<std::pair<unsigned short, unsigned short>> modInfo);
+                    ModListId modInfo);
   void BFS(std::queue<std::tuple<int,int,int>> node_queue,
            std::vector<std::vector<std::vector<short int>>> T,
            std::vector<std::vector<std::vector<std::vector<prePosition>>>> E,
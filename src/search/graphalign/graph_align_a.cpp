@@ -23,6 +23,10 @@
 #include <ctime>
 #include <queue>
 #include <iomanip>
+#include <atomic>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/barrier.hpp>
 
 #include "seq/proteoform_factory.hpp"
 #include "ms/spec/extend_ms_factory.hpp"
@@ -30,6 +34,9 @@
 #include "search/oneptmsearch/diagonal_header.hpp"
 #include "search/graph/graph.hpp"
 #include "search/graphalign/graph_align_a.hpp"
+#include "search/graphalign/graph_abund_search.hpp"
+#include "search/graphalign/graph_two_path_batch.hpp"
+#include "search/graphalign/graph_align_stats.hpp"
 #include "search/graphalign/graph_align_processor.hpp"
 #include "prsm/prsm_algo.hpp"
 
@@ -39,52 +46,26 @@
 
 namespace toppic {
 
-std::vector<int> getMinMaxProtDist2(DistVec2D dist_vec) {
-  std::vector<int> min_dist, max_dist;
-  for (size_t i = 0; i < dist_vec.size(); i++) {
-    if (dist_vec[i].size() == 0) continue;
-    min_dist.push_back(dist_vec[i][0].dist_);
-    max_dist.push_back(dist_vec[i][dist_vec[i].size() - 1].dist_);
-  }
-  std::sort(min_dist.begin(), min_dist.end());
-  std::sort(max_dist.begin(), max_dist.end());
-  std::vector<int> res;
-  res.push_back(min_dist[0]);
-  res.push_back(max_dist[max_dist.size() - 1]);
-  return res;
-}
 
 GraphAlignSim::GraphAlignSim(GraphAlignMngPtr mng_ptr,
                        ProteoGraphPtr proteo_graph_ptr,
-                       SpecGraphPtr_sim spec_graph_ptr) {
+                       SpecGraphPtr_sim spec_graph_ptr,
+                       GraphAlignRecordPtr record_ptr,
+                       GraphAlignTablePtr table_ptr) {
   LOG_DEBUG("Graph constructor start");
   mng_ptr_ = mng_ptr;
+  record_ptr_ = record_ptr;
+  table_ptr_ = table_ptr;
+  mod_list_pool_ptr_ = proteo_graph_ptr->getModListPoolPtr();
   proteo_graph_ptr_ = proteo_graph_ptr;
   spec_graph_ptr_ = spec_graph_ptr;
 
-  dist_vec_ = proteo_graph_ptr_->getDistVec2D();
-  spec_dist_ = spec_graph_ptr_->getDistVec();
-
-  std::vector<int> cutoff = getMinMaxProtDist2(dist_vec_);
-  cutoff[0] -= mng_ptr_->getIntTolerance();
-  cutoff[1] += mng_ptr_->getIntTolerance();
-  //std::cout << "cutoff[0]: " << cutoff[0] << ", cutoff[1]: " << cutoff[0] << std::endl;
-
-  spec_dist_.erase(
-      std::remove_if(spec_dist_.begin(), spec_dist_.end(),
-                     [cutoff](Dist d){return d.dist_ < cutoff[0] || d.dist_ > cutoff[1];}),
-      spec_dist_.end());
-
-  std::sort(spec_dist_.begin(), spec_dist_.end(), distVecUp);
+  dist_vec_ptr_ = &proteo_graph_ptr_->getDistVec2D();
 
-  for (int i = 0; i < mng_ptr->max_known_mods_ + 1; i++) {
-    std::sort(dist_vec_[i].begin(), dist_vec_[i].end(), distVecUp);
-  }
-
-  pg_ = proteo_graph_ptr_->getMassGraphPtr();
-  sg_ = spec_graph_ptr_->getMassGraphPtr();
-  proteo_ver_num_ = num_vertices(*pg_.get());
-  spec_ver_num_ = num_vertices(*sg_.get());
+  pg_ = proteo_graph_ptr_->getChainGraphPtr();
+  sg_ = spec_graph_ptr_->getChainGraphPtr();
+  proteo_ver_num_ = pg_->getVertexNum();
+  spec_ver_num_ = sg_->getVertexNum();
   LOG_DEBUG("Graph constructor end");
 }
 
@@ -425,64 +406,91 @@ ReturnStruct GraphAlignSim::topMG(){
 
 
 void GraphAlignSim::TopMGFast(){
-  //std::cout << "here start" << std::endl;
-  clock_t startTime, midTime, endTime;
-  
-  startTime = clock();
-  //std::cout << "start1" << std::endl;
-  getDelta_ori();
-  //std::cout << "start12" << std::endl;
-  deleteOverlap_v2();
-  //std::cout << "start34" << std::endl;
-  getNewConsPair();
-  //std::cout << "end" << std::endl;
-  
-  midTime = clock();
+  GraphAlignStats & stats = record_ptr_->getStats();
+  stats.setCount("proteo_vertices", proteo_ver_num_);
+  stats.setCount("spec_vertices", spec_ver_num_);
+  {
+    GraphAlignTimer timer(stats, "delta");
+    getDelta();
+    deleteOverlap_v2();
+    getSpecDist();
+  }
+  int delta_sum = 0;
+  for (size_t i = 0; i < deltaL.size(); i++) {
+    delta_sum += deltaL[i] + deltaR[i];
+  }
+  stats.setCount("delta_sum", delta_sum);
+  {
+    GraphAlignTimer timer(stats, "cons_pair");
+    getNewConsPair();
+  }
+  stats.setCount("cons_pairs", cons_pair_table_.getPairNum());
+
   //computeT_s();
   bool case1 = false;
   double ptm_mass = 79.966331;
   std::cout<<"bgn computTv2"<<std::endl;
   computeT_v2(case1, ptm_mass);
-
-  endTime = clock();
-  double cijTime = (double)(midTime - startTime) / CLOCKS_PER_SEC;
-  double runningTime = (double)(endTime - midTime) / CLOCKS_PER_SEC;
-  std::cout << "Running time of creating cij is: " << cijTime * 1000 << " ms" << std::endl;
-  std::cout << "Running time of dp is: " << runningTime * 1000 << " ms" << std::endl;
-  std::cout << "Totle running time is: " << (runningTime + cijTime) * 1000 << " ms" << std::endl; 
 }
 
 
 
-void GraphAlignSim::getDelta_complex(double totalMass){
+void GraphAlignSim::getDelta(){
+  if (mng_ptr_->tolerance_model_ == "PPM") {
+    getDelta_ppm();
+  } else {
+    getDelta_ori();
+  }
+}
+
+void GraphAlignSim::getDelta_ppm(){
 
   spectrumMass.clear();
-  auto aa = spec_graph_ptr_->getPeakPtrVec();
+  const std::vector<std::pair<PeakPtr, SpecPeakType>> & aa = spec_graph_ptr_->getPeakPtrVec();
   for(auto peakIter = aa.begin(); peakIter != aa.end(); peakIter++){
     int mass = static_cast<int>(std::round((*peakIter).first->getPosition() * mng_ptr_->convert_ratio_));
     spectrumMass.push_back(mass);
   }
 
-  delta.clear();
-
+  // the prm of a reversed peak is computed from the precursor mass, so its
+  // error is bounded by the tolerance of the precursor mass plus that of
+  // the fragment mass
+  double prec_mass = aa.back().first->getPosition();
+  for(size_t i = 0; i < aa.size(); i++){
+    if(aa[i].second == SpecPeakType::PREC){
+      prec_mass = aa[i].first->getPosition();
+      break;
+    }
+  }
 
   SpParaPtr sp_para_ptr = mng_ptr_->prsm_para_ptr_->getSpParaPtr();
-  double ppo = sp_para_ptr->getPeakTolerancePtr()->getPpo();
+  PeakTolerancePtr tole_ptr = sp_para_ptr->getPeakTolerancePtr();
+  delta.clear();
   maxDelta = 0;
   delta.push_back(0);
   for(int i = 1; i < spec_ver_num_; i++){
-    auto a = aa[i].second;
-    //auto a = spec_graph_ptr_->getPrmPeakPtr(i)->getBaseTypePtr()->getName();
-    if(a == "Original"){
-      int temp = static_cast<int>(std::round(spectrumMass[i] * ppo + 0.1 * mng_ptr_->convert_ratio_));
-      delta.push_back(temp);
-      if(temp > maxDelta) maxDelta = temp;
-    }
-    else if(a == "Reversed") {
-      int temp = static_cast<int>(std::round(spectrumMass[i] * ppo + totalMass * mng_ptr_->convert_ratio_ * ppo + 0.1 * mng_ptr_->convert_ratio_));
-      delta.push_back(temp);
-      if(temp > maxDelta) maxDelta = temp;
-    }    
+    double mass = aa[i].first->getPosition();
+    double err = 0;
+    switch (aa[i].second) {
+      case SpecPeakType::ZERO:
+        break;
+      case SpecPeakType::ORIGINAL:
+        err = tole_ptr->compStrictErrorTole(mass);
+        break;
+      case SpecPeakType::REVERSED:
+        err = tole_ptr->compRelaxErrorTole(std::max(prec_mass - mass, 0.0), prec_mass);
+        break;
+      case SpecPeakType::PREC:
+        err = tole_ptr->compStrictErrorTole(prec_mass);
+        break;
+    }
+    // one more unit for the rounding of the masses to integers
+    int temp = 0;
+    if (aa[i].second != SpecPeakType::ZERO) {
+      temp = static_cast<int>(std::ceil(err * mng_ptr_->convert_ratio_)) + 1;
+    }
+    delta.push_back(temp);
+    if(temp > maxDelta) maxDelta = temp;
   }
 }
 
@@ -618,43 +626,58 @@ void GraphAlignSim::deleteOverlap_v2(){
 
 
 
+void GraphAlignSim::getSpecDist() {
+  // only spectrum distances that can match a protein distance are computed
+  int tole = mng_ptr_->getIntTolerance();
+  if (mng_ptr_->tolerance_model_ == "PPM") {
+    // getNewConsPair matches a spectrum distance of peaks a < b with the
+    // protein distances in [dist - deltaR[a] - deltaL[b], dist + deltaL[a]
+    // + deltaR[b]], so the cutoff is widened to the largest such window
+    int max_l = 0, max_r = 0;
+    for (size_t i = 0; i < deltaL.size(); i++) {
+      max_l = std::max(max_l, deltaL[i]);
+      max_r = std::max(max_r, deltaR[i]);
+    }
+    tole = std::max(tole, max_l + max_r);
+  }
+  int min_cutoff = proteo_graph_ptr_->getMinDist() - tole;
+  int max_cutoff = proteo_graph_ptr_->getMaxDist() + tole;
+  spec_graph_ptr_->compSpecDistances(min_cutoff, max_cutoff, spec_dist_);
+}
+
 void GraphAlignSim::getNewConsPair() {
 
   //int tole = maxDelta * 2;
   //std::cout << "maxDelta: " << maxDelta << std::endl;
   //int totalTole = 0;
 
-  std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,std::vector<std::pair<unsigned short,unsigned short>>>>>> empty_vec;
-  for (int i = 0; i < proteo_ver_num_; i++) {
-    std::vector<std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,std::vector<std::pair<unsigned short,unsigned short>>>>>>> empty_vec_2d;
-    for (int j = 0; j < spec_ver_num_; j++) {
-      empty_vec_2d.push_back(empty_vec);
-    }
-    new_cons_pairs_.push_back(empty_vec_2d);
-  }
+  cons_pair_table_.init(proteo_ver_num_, spec_ver_num_);
+  const DistVec2D & dist_vec = *dist_vec_ptr_;
 
   int min_dist = mng_ptr_->getIntMinConsistentDist();
-  for (size_t m = 0; m < dist_vec_.size(); m++) {
-    if (dist_vec_[m].size() == 0) continue;
-    size_t spec_idx_min = 0, specidx = 0;
-    size_t maxIdx = spec_dist_.size();
-    for (size_t prot_idx = 0; prot_idx < dist_vec_[m].size(); prot_idx++){
-      int pr_dist = dist_vec_[m][prot_idx].dist_;
+  for (size_t m = 0; m < dist_vec.size(); m++) {
+    if (dist_vec[m].size() == 0) continue;
+    int spec_idx_min = 0, specidx = 0;
+    int spec_group_num = spec_dist_.getGroupNum();
+    int maxIdx = spec_group_num;
+    for (size_t prot_idx = 0; prot_idx < dist_vec[m].size(); prot_idx++){
+      int pr_dist = dist_vec[m][prot_idx].dist_;
       if (pr_dist < min_dist) continue;
       //(pr_dist == 321397 || pr_dist == 107033 || pr_dist == 267325 || pr_dist == 270616 || pr_dist == 515198)
       bool flag1 = true, flag2 = true;
-      maxIdx = spec_dist_.size();
+      maxIdx = spec_group_num;
       specidx = spec_idx_min;
       //std::cout << "prot_idx: " << prot_idx << ", " << spec_idx_min << ", " << specidx << ", " << maxIdx << std::endl;
-      while (specidx < spec_dist_.size() && specidx < maxIdx){
-        auto specPair = spec_dist_[specidx].pair_ij_;
-        int specDist = spec_dist_[specidx].dist_;
+      while (specidx < spec_group_num && specidx < maxIdx){
+        const std::pair<int, int> * specPair = spec_dist_.getPairs(specidx);
+        int specPairNum = spec_dist_.getPairNum(specidx);
+        int specDist = spec_dist_.getDist(specidx);
         //std::cout << "specidx: " << specidx << "; ( "<< specDist << ", " << pr_dist;
         int maxD = 0;
         int minD = 0;
-        for(auto iter = specPair.begin(); iter != specPair.end(); iter++){
-          int tempMax = deltaL[(*iter).first.first] + deltaR[(*iter).first.second];
-          int tempMin = deltaR[(*iter).first.first] + deltaL[(*iter).first.second];
+        for(int p = 0; p < specPairNum; p++){
+          int tempMax = deltaL[specPair[p].first] + deltaR[specPair[p].second];
+          int tempMin = deltaR[specPair[p].first] + deltaL[specPair[p].second];
           if(tempMax > maxD) maxD = tempMax;
           if(tempMin > minD) minD = tempMin;
         }
@@ -665,8 +688,8 @@ void GraphAlignSim::getNewConsPair() {
         //   }
         //   std::cout << std::endl;
         //   std::cout << "protPair: " << std::endl;
-        //   for(int i22 = 0; i22 < dist_vec_[m][prot_idx].pair_ij_.size(); i22++){
-        //     std::cout << "(" << dist_vec_[m][prot_idx].pair_ij_[i22].first.first << ", " << dist_vec_[m][prot_idx].pair_ij_[i22].first.second << "),";
+        //   for(int i22 = 0; i22 < dist_vec[m][prot_idx].pair_ij_.size(); i22++){
+        //     std::cout << "(" << dist_vec[m][prot_idx].pair_ij_[i22].first.first << ", " << dist_vec[m][prot_idx].pair_ij_[i22].first.second << "),";
         //   }
         //   std::cout << std::endl;
         // }
@@ -682,7 +705,7 @@ void GraphAlignSim::getNewConsPair() {
               flag1 = false;
             }
             //std::cout << "match1 with spec_idx_min: " << spec_idx_min << std::endl;
-            addToNewConsistentPairs(pr_dist, specPair, dist_vec_[m][prot_idx].pair_ij_);
+            addToNewConsistentPairs(pr_dist, specPair, specPairNum, dist_vec[m][prot_idx].pair_ij_);
             specidx++;
           }
         }
@@ -697,7 +720,7 @@ void GraphAlignSim::getNewConsPair() {
           }
           else{
             //std::cout << "match2" << std::endl;
-            addToNewConsistentPairs(pr_dist, specPair, dist_vec_[m][prot_idx].pair_ij_);
+            addToNewConsistentPairs(pr_dist, specPair, specPairNum, dist_vec[m][prot_idx].pair_ij_);
             flag2 = true;
             maxIdx++;
             specidx++;
@@ -706,9 +729,8 @@ void GraphAlignSim::getNewConsPair() {
         
       }
     }
-    dist_vec_[m].clear();
   }
-  dist_vec_.clear();
+  cons_pair_table_.build();
   LOG_DEBUG("consistent pair end");
   //std::cout << "End getting new Cons_Pairs." << std::endl;
 }
@@ -716,245 +738,118 @@ void GraphAlignSim::getNewConsPair() {
 
 
 
-void GraphAlignSim::addToNewConsistentPairs(int mass, const std::vector<std::pair<std::pair<int, int>, std::vector<std::pair<unsigned short,unsigned short>>>> & sp_pair_ij,
-                                      const std::vector<std::pair<std::pair<int, int>, std::vector<std::pair<unsigned short,unsigned short>>>> & pg_pair_ij) {
-  
-  std::vector<std::pair<std::pair<unsigned short, unsigned short>,std::vector<std::pair<unsigned short,unsigned short>>>> prePairList;
+void GraphAlignSim::addToNewConsistentPairs(int mass, const std::pair<int, int> * sp_pair_ij, int sp_pair_num,
+                                      const std::vector<std::pair<std::pair<int, int>, ModListId>> & pg_pair_ij) {
   for (size_t k = 0; k < pg_pair_ij.size(); k++) {
-    for (size_t sp = 0; sp < sp_pair_ij.size(); sp++) {
-      prePairList.clear();
+    for (int sp = 0; sp < sp_pair_num; sp++) {
       short int pr_v1 = pg_pair_ij[k].first.first;
       short int pr_v2 = pg_pair_ij[k].first.second;
-      short int sp_v1 = sp_pair_ij[sp].first.first;
-      short int sp_v2 = sp_pair_ij[sp].first.second;
+      short int sp_v1 = sp_pair_ij[sp].first;
+      short int sp_v2 = sp_pair_ij[sp].second;
       int maxD = deltaL[sp_v1] + deltaR[sp_v2];
       int minD = deltaR[sp_v1] + deltaL[sp_v2];
       int specMass = spectrumMass[sp_v2] - spectrumMass[sp_v1];
       if(specMass - mass <= maxD || mass - specMass <= minD){
-        short int cSize = new_cons_pairs_[pr_v2][sp_v2].size();
-        if(cSize > 0){
-          if(new_cons_pairs_[pr_v2][sp_v2][cSize - 1].first == mass){
-            prePairList = new_cons_pairs_[pr_v2][sp_v2][cSize - 1].second;
-            bool find = false;
-            for(int iter = 0; iter < prePairList.size(); iter++){
-              if(prePairList[iter].first.first == pr_v1 && prePairList[iter].first.second == sp_v1){
-                find = true;
-              }
-            }
-            if(find == false){
-              prePairList.insert(prePairList.begin(), std::make_pair(std::make_pair(pr_v1, sp_v1), pg_pair_ij[k].second));
-              new_cons_pairs_[pr_v2][sp_v2][cSize - 1].second = prePairList;
-            }
-          } else{
-            prePairList.emplace_back(std::make_pair(std::make_pair(pr_v1, sp_v1), pg_pair_ij[k].second));
-            new_cons_pairs_[pr_v2][sp_v2].emplace_back(std::make_pair(mass, prePairList));
-          }
-        }else{
-          prePairList.emplace_back(std::make_pair(std::make_pair(pr_v1, sp_v1), pg_pair_ij[k].second));
-          new_cons_pairs_[pr_v2][sp_v2].emplace_back(std::make_pair(mass, prePairList));
-        }
-        // if(pr_v2 == 141 && sp_v2 == 18){
-        //   std::cout << "new_cons_pairs_[pr_v2][sp_v2]:" << new_cons_pairs_[pr_v2][sp_v2].size()<<std::endl;
-        // }
+        cons_pair_table_.addPair(pr_v2, sp_v2, mass, pr_v1, sp_v1, pg_pair_ij[k].second);
       }
-      /*
-      std::cout << "Update c[" << pr_v2 << "][" << sp_v2 << "] as {";
-      auto li = new_cons_pairs_[pr_v2][sp_v2]; 
-      for(int iter = 0; iter < li.size(); iter++){
-        std::cout << "(" << li[iter].first << ",";
-        auto l2 = li[iter].second;
-        for(int i2 = 0; i2 < l2.size(); i2++){
-          std::cout << "<" << l2[i2].first.first << "," << l2[i2].first.second << ",";
-          auto l3 = l2[i2].second;
-          for(int i3 = 0; i3 < l3.size(); i3++){
-            std::cout << "$" << l3[i3].first << "," << l3[i3].second << "$,";
-          }
-          std::cout << ">,";
-        }
-        std::cout << "),";
-      }
-      std::cout << "}" << std::endl;
-      */
-    }  
+    }
   }
 }
 
 
 
-
-void GraphAlignSim:: computeT_v2(bool case1, double ptm_mass){ //whole spectrum and surfix of protein
-
-  //**********Build and initialize T[i,j,k] and E[i,j,k]******************
-  
-  std::vector<std::vector<std::vector<short int>>> T(proteo_ver_num_);
-  std::vector<std::vector<std::vector<std::vector<prePosition>>>> E(proteo_ver_num_);
-  for(int i = 0; i < proteo_ver_num_; i++){
-    T[i].resize(spec_ver_num_);
-    E[i].resize(spec_ver_num_);
-    for(int j = 0; j < spec_ver_num_; j++){
-      int size_k = deltaL[j] + deltaR[j] + 1;
-      T[i][j].resize(size_k);
-      E[i][j].resize(size_k);
+bool GraphAlignSim::planTableMem(bool & store_pres) {
+  store_pres = true;
+  int64_t budget = mng_ptr_->getMemBudgetBytes();
+  if (budget <= 0) {
+    return true;
+  }
+  // each group of consistent pairs adds at most one predecessor to a cell
+  int64_t cell_num = deltaL[0] + deltaR[0] + 1;
+  int64_t pre_num = 0;
+  for (int i = 0; i < proteo_ver_num_; i++) {
+    for (int j = 0; j < spec_ver_num_; j++) {
+      int group_num = cons_pair_table_.getGroupEnd(i, j) - cons_pair_table_.getGroupBegin(i, j);
+      if (group_num > 0) {
+        int k_num = deltaL[j] + deltaR[j] + 1;
+        cell_num += k_num;
+        pre_num += static_cast<int64_t>(group_num) * k_num;
+      }
     }
   }
+  GraphAlignStats & stats = record_ptr_->getStats();
+  int64_t cons_bytes = cons_pair_table_.getMemBytes();
+  int64_t full_bytes = GraphAlignTable::estimateMemBytes(proteo_ver_num_, spec_ver_num_,
+                                                         cell_num, pre_num, true);
+  stats.setCount("table_kb", full_bytes >> 10);
+  if (cons_bytes + full_bytes <= budget) {
+    return true;
+  }
+  // the low-memory table keeps the consistent pairs to recompute the
+  // predecessors of the cells in the backtracking graph
+  int64_t low_bytes = GraphAlignTable::estimateMemBytes(proteo_ver_num_, spec_ver_num_,
+                                                        cell_num, 0, false);
+  if (cons_bytes + low_bytes <= budget) {
+    store_pres = false;
+    stats.setCount("low_mem_table", 1);
+    return true;
+  }
+  LOG_WARN("The T table of " << ((cons_bytes + low_bytes) >> 20)
+           << " MB exceeds the memory budget of " << mng_ptr_->mem_budget_mb_ << " MB!");
+  return false;
+}
 
-  //initialize T[i,j,k] to be 1;
-  for(size_t i = 0; i < T.size(); i++){
-    for(size_t j = 0; j < T[i].size(); j++){
-      for(size_t k = 0; k < T[i][j].size(); k++){
-//        if(j == 0){
-        if(j == 0 && i == 0 && k == 0){
-          T[i][j][k] = 1;
+bool GraphAlignSim::computeTableT(GraphAlignTable & table) {
+  // T[0,0,0] = 1 and all other cells are -1. Only (i, j) with consistent
+  // pairs can be reached, so only their cells are stored.
+  GraphAlignStats & stats = record_ptr_->getStats();
+  bool store_pres;
+  if (!planTableMem(store_pres)) {
+    cons_pair_table_.clear();
+    return false;
+  }
+  {
+    GraphAlignTimer timer(stats, "dp");
+    table.init(proteo_ver_num_, deltaL, deltaR, store_pres);
+    for(int i = 0; i < proteo_ver_num_; i++){
+      for(int j = 0; j < spec_ver_num_; j++){
+        if(cons_pair_table_.getGroupBegin(i, j) < cons_pair_table_.getGroupEnd(i, j)){
+          table.addCell(i, j);
         }
-        else T[i][j][k] = -1;
-
       }
     }
-  }
-
 
-  //std::cout << "ini" << std::endl;
-
-  for(int i = 0; i < proteo_ver_num_; i++){
-    for(int j = 0; j < spec_ver_num_; j++){
-      auto cij = new_cons_pairs_[i][j];
-      for(auto m_iter = cij.begin(); m_iter != cij.end(); m_iter++){
-        int current_pointer = 0;
-        // Computing T[i,j,0];
-        auto list = m_iter->second;
-        unsigned int exactM = m_iter->first;
-        int listSize = list.size();
-        bool preFound = false;
-        for(int q = 0; q < listSize; q++){
-          unsigned short i_pre = list[q].first.first;
-          unsigned short j_pre = list[q].first.second;
-          auto mod_info = list[q].second;
-          if(spectrumMass[j_pre] >= (spectrumMass[j] - deltaL[j] - exactM - deltaR[j_pre]) && spectrumMass[j_pre] <= (spectrumMass[j] - deltaL[j] - exactM + deltaL[j_pre])){
-            short int k_pre = spectrumMass[j] - deltaL[j] - exactM - spectrumMass[j_pre] + deltaL[j_pre];
-            current_pointer = q;
-            preFound = true;
-            if(T[i_pre][j_pre][k_pre] + 1 > 0){
-              if(T[i][j][0] == T[i_pre][j_pre][k_pre] + 1){
-                E[i][j][0].emplace_back(std::make_pair(std::make_pair(i_pre, j_pre), std::make_tuple(k_pre - deltaL[j_pre], exactM, mod_info)));
-              }
-              if(T[i][j][0] < T[i_pre][j_pre][k_pre] + 1){
-                T[i][j][0] = T[i_pre][j_pre][k_pre] + 1;
-//                E[i][j][0].clear();
-                E[i][j][0].emplace_back(std::make_pair(std::make_pair(i_pre, j_pre), std::make_tuple(k_pre - deltaL[j_pre], exactM, mod_info)));
-              }
-            }
-            break;
-          }
-        }
-        //std::cout << "current i: " << i << " and j: " << j << std::endl;
-
-        //Computing T[i,j,k] to T[i,j,deltaL[j] + deltaR[j]];
-        for(int k = 1; k <= deltaL[j] + deltaR[j]; k++){
-          bool update = false;
-          short int offsent = k - deltaL[j];
-          short int i_pre = list[current_pointer].first.first;
-          short int j_pre = list[current_pointer].first.second;
-          auto mod_info = list[current_pointer].second;
-          if(preFound == true){
-            if(spectrumMass[j_pre] >= (spectrumMass[j] + offsent - exactM - deltaR[j_pre]) && spectrumMass[j_pre] <= (spectrumMass[j] + offsent - exactM + deltaL[j_pre])){
-              update = true;
-              short int k_pre = spectrumMass[j] + offsent - exactM - spectrumMass[j_pre] + deltaL[j_pre];
-              //int i_star = E[i][j][k-1].first.first;
-              //int j_star = E[i][j][k-1].first.second;
-              if(T[i_pre][j_pre][k_pre] + 1 > 0){
-                if(T[i][j][k] == T[i_pre][j_pre][k_pre] + 1){
-                  E[i][j][k].emplace_back(std::make_pair(std::make_pair(i_pre, j_pre), std::make_tuple(k_pre - deltaL[j_pre], exactM, mod_info)));
-                }
-                if(T[i][j][k] < T[i_pre][j_pre][k_pre] + 1){
-                  T[i][j][k] = T[i_pre][j_pre][k_pre] + 1;
-//                  E[i][j][k].clear();
-                  E[i][j][k].emplace_back(std::make_pair(std::make_pair(i_pre, j_pre), std::make_tuple(k_pre - deltaL[j_pre], exactM, mod_info)));
-                }
-              }
-//              if(i_star == list[current_pointer].first && j_star == list[current_pointer].second){
-//                if(T[i][j][k-1] > T[i][j][k] && T[i][j][k-1] >= T[i_star][j_star][k_star + 1] + 1){
-//                  T[i][j][k] = T[i][j][k-1];
-//                  E[i][j][k] = std::make_pair(E[i][j][k-1].first, E[i][j][k-1].second + 1);
-//                }
-//                else if(T[i_star][j_star][k_star + 1] + 1 > T[i][j][k] && T[i_star][j_star][k_star + 1] + 1 > T[i][j][k-1]){
-//                  T[i][j][k] = T[i_star][j_star][k_star + 1] + 1;
-//                  E[i][j][k] = std::make_pair(E[i][j][k-1].first, E[i][j][k-1].second + 1);
-//                }
-//              }
-            }
-            else{
-              int iter_point = current_pointer;
-              while(iter_point <= listSize - 1){
-                short int i_pre = list[iter_point].first.first;
-                short int j_pre = list[iter_point].first.second;
-                auto mod_info = list[iter_point].second;
-                if(spectrumMass[j_pre] >= (spectrumMass[j] + offsent - exactM - deltaR[j_pre]) && spectrumMass[j_pre] <= (spectrumMass[j] + offsent - exactM + deltaL[j_pre])){
-                  short int k_pre = spectrumMass[j] + offsent - exactM - spectrumMass[j_pre] + deltaL[j_pre];
-                  update = true;
-                  current_pointer = iter_point;
-                  if(T[i_pre][j_pre][k_pre] + 1 > 0){
-                    if(T[i][j][k] == T[i_pre][j_pre][k_pre] + 1){
-                      E[i][j][k].emplace_back(std::make_pair(std::make_pair(i_pre, j_pre), std::make_tuple(k_pre - deltaL[j_pre], exactM, mod_info)));
-                    }
-                    if(T[i][j][k] < T[i_pre][j_pre][k_pre] + 1){
-                      T[i][j][k] = T[i_pre][j_pre][k_pre] + 1;
-//                      E[i][j][k].clear();
-                      E[i][j][k].emplace_back(std::make_pair(std::make_pair(i_pre, j_pre), std::make_tuple(k_pre - deltaL[j_pre], exactM, mod_info)));
-                    }
-                  }
-                  break;
-                }
-                iter_point++;
-              }
-            }
-            if(current_pointer == listSize -1 && update == false && spectrumMass[list[current_pointer].first.second] < (spectrumMass[j] + offsent - exactM - deltaR[list[current_pointer].first.second])) break;  
-            if(update == false) preFound = false;
-          }
-          else{
-            int iter_point = current_pointer;
-            while(iter_point <= listSize - 1){
-                short int i_pre = list[iter_point].first.first;
-                short int j_pre = list[iter_point].first.second;
-                auto mod_info = list[iter_point].second;
-              if(spectrumMass[j_pre] >= (spectrumMass[j] + offsent - exactM - deltaR[j_pre]) && spectrumMass[j_pre] <= (spectrumMass[j] + offsent - exactM + deltaL[j_pre])){
-                short int k_pre = spectrumMass[j] + offsent - exactM - spectrumMass[j_pre] + deltaL[j_pre];
-                preFound = true;
-                current_pointer = iter_point;
-                if(T[i_pre][j_pre][k_pre] + 1 > 0){
-                  if(T[i][j][k] == T[i_pre][j_pre][k_pre] + 1){
-                    E[i][j][k].emplace_back(std::make_pair(std::make_pair(i_pre, j_pre), std::make_tuple(k_pre - deltaL[j_pre], exactM, mod_info)));
-                  }
-                  if(T[i][j][k] < T[i_pre][j_pre][k_pre] + 1){
-                    T[i][j][k] = T[i_pre][j_pre][k_pre] + 1;
-//                    E[i][j][k].clear();
-                    E[i][j][k].emplace_back(std::make_pair(std::make_pair(i_pre, j_pre), std::make_tuple(k_pre - deltaL[j_pre], exactM, mod_info)));
-                  }
-                }
-                break;
-              }
-              iter_point++;
-            }
-          }
-          /*
-          if(T[i][j][k]>0){
-            std::cout << "T[" << i << "," << j << "," << k << "] = " << T[i][j][k] << "; preNode: {";
-            for(int piter = 0; piter < E[i][j][k].size(); piter++){
-              std::cout << "[" << E[i][j][k][piter].first.first << ", " << E[i][j][k][piter].first.second << ", " << std::get<0>(E[i][j][k][piter].second) << "]," << std::get<1>(E[i][j][k][piter].second) << ";";
-            }
-            std::cout << "}" << std::endl;
-          }
-          */
-          
+    int thread_num = std::min(mng_ptr_->dp_thread_num_, spec_ver_num_);
+    if (thread_num > 1) {
+      computeRowsT(table, thread_num);
+    }
+    else {
+      GraphAlignCellPres cell_pres;
+      for(int i = 0; i < proteo_ver_num_; i++){
+        for(int j = 0; j < spec_ver_num_; j++){
+          computeCellT(table, cell_pres, i, j);
+          table.closeCell(i, j, cell_pres);
         }
       }
     }
-    new_cons_pairs_[i].clear();
-    std::vector<std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,std::vector<std::pair<unsigned short,unsigned short>>>>>>>().swap(new_cons_pairs_[i]);
+    if (store_pres) {
+      cons_pair_table_.clear();
+    }
+  }
+  stats.setCount("dp_cells", table.getCellNum());
+  return true;
+}
+
+void GraphAlignSim:: computeT_v2(bool case1, double ptm_mass){ //whole spectrum and surfix of protein
+
+  //**********Build and initialize T[i,j,k] and E[i,j,k]******************
+  GraphAlignTable & table = *table_ptr_;
+  if (!computeTableT(table)) {
+    outputPruned(graph_align_prune::MEMORY_LIMIT);
+    return;
   }
-  new_cons_pairs_.clear();
-  NewConsPairs().swap(new_cons_pairs_);
 
-  Quantification(T,E);
+  Quantification(table);
 
 
 
@@ -1175,6 +1070,150 @@ void GraphAlignSim:: computeT_v2(bool case1, double ptm_mass){ //whole spectrum
 //  //std::vector<int>().swap(delta);
 }
 
+
+// The predecessors of (i_pre, j_pre) are in rows before i, so the cells of
+// (i, j) only read rows that are already complete.
+void GraphAlignSim::computeCellT(GraphAlignTable & table, GraphAlignCellPres & cell_pres,
+                                 int i, int j){
+  for(int g = cons_pair_table_.getGroupBegin(i, j); g < cons_pair_table_.getGroupEnd(i, j); g++){
+    int current_pointer = 0;
+    // Computing T[i,j,0];
+    const GraphConsPair * list = cons_pair_table_.getGroupPairs(g);
+    unsigned int exactM = cons_pair_table_.getGroupMass(g);
+    int listSize = cons_pair_table_.getGroupPairNum(g);
+    bool preFound = false;
+    for(int q = 0; q < listSize; q++){
+      unsigned short i_pre = list[q].first.first;
+      unsigned short j_pre = list[q].first.second;
+      const auto & mod_info = list[q].second;
+      if(spectrumMass[j_pre] >= (spectrumMass[j] - deltaL[j] - exactM - deltaR[j_pre]) && spectrumMass[j_pre] <= (spectrumMass[j] - deltaL[j] - exactM + deltaL[j_pre])){
+        short int k_pre = spectrumMass[j] - deltaL[j] - exactM - spectrumMass[j_pre] + deltaL[j_pre];
+        current_pointer = q;
+        preFound = true;
+        short int t_pre = table.getT(i_pre, j_pre, k_pre);
+        if(t_pre + 1 > 0){
+          if(table.getT(i, j, 0) == t_pre + 1){
+            cell_pres.add(0, i_pre, j_pre, k_pre - deltaL[j_pre], exactM, mod_info);
+          }
+          if(table.getT(i, j, 0) < t_pre + 1){
+            table.setT(i, j, 0, t_pre + 1);
+            cell_pres.add(0, i_pre, j_pre, k_pre - deltaL[j_pre], exactM, mod_info);
+          }
+        }
+        break;
+      }
+    }
+    //std::cout << "current i: " << i << " and j: " << j << std::endl;
+
+    //Computing T[i,j,k] to T[i,j,deltaL[j] + deltaR[j]];
+    for(int k = 1; k <= deltaL[j] + deltaR[j]; k++){
+      bool update = false;
+      short int offsent = k - deltaL[j];
+      short int i_pre = list[current_pointer].first.first;
+      short int j_pre = list[current_pointer].first.second;
+      const auto & mod_info = list[current_pointer].second;
+      if(preFound == true){
+        if(spectrumMass[j_pre] >= (spectrumMass[j] + offsent - exactM - deltaR[j_pre]) && spectrumMass[j_pre] <= (spectrumMass[j] + offsent - exactM + deltaL[j_pre])){
+          update = true;
+          short int k_pre = spectrumMass[j] + offsent - exactM - spectrumMass[j_pre] + deltaL[j_pre];
+          short int t_pre = table.getT(i_pre, j_pre, k_pre);
+          if(t_pre + 1 > 0){
+            if(table.getT(i, j, k) == t_pre + 1){
+              cell_pres.add(k, i_pre, j_pre, k_pre - deltaL[j_pre], exactM, mod_info);
+            }
+            if(table.getT(i, j, k) < t_pre + 1){
+              table.setT(i, j, k, t_pre + 1);
+              cell_pres.add(k, i_pre, j_pre, k_pre - deltaL[j_pre], exactM, mod_info);
+            }
+          }
+        }
+        else{
+          int iter_point = current_pointer;
+          while(iter_point <= listSize - 1){
+            short int i_pre = list[iter_point].first.first;
+            short int j_pre = list[iter_point].first.second;
+            const auto & mod_info = list[iter_point].second;
+            if(spectrumMass[j_pre] >= (spectrumMass[j] + offsent - exactM - deltaR[j_pre]) && spectrumMass[j_pre] <= (spectrumMass[j] + offsent - exactM + deltaL[j_pre])){
+              short int k_pre = spectrumMass[j] + offsent - exactM - spectrumMass[j_pre] + deltaL[j_pre];
+              update = true;
+              current_pointer = iter_point;
+              short int t_pre = table.getT(i_pre, j_pre, k_pre);
+              if(t_pre + 1 > 0){
+                if(table.getT(i, j, k) == t_pre + 1){
+                  cell_pres.add(k, i_pre, j_pre, k_pre - deltaL[j_pre], exactM, mod_info);
+                }
+                if(table.getT(i, j, k) < t_pre + 1){
+                  table.setT(i, j, k, t_pre + 1);
+                  cell_pres.add(k, i_pre, j_pre, k_pre - deltaL[j_pre], exactM, mod_info);
+                }
+              }
+              break;
+            }
+            iter_point++;
+          }
+        }
+        if(current_pointer == listSize -1 && update == false && spectrumMass[list[current_pointer].first.second] < (spectrumMass[j] + offsent - exactM - deltaR[list[current_pointer].first.second])) break;  
+        if(update == false) preFound = false;
+      }
+      else{
+        int iter_point = current_pointer;
+        while(iter_point <= listSize - 1){
+            short int i_pre = list[iter_point].first.first;
+            short int j_pre = list[iter_point].first.second;
+            const auto & mod_info = list[iter_point].second;
+          if(spectrumMass[j_pre] >= (spectrumMass[j] + offsent - exactM - deltaR[j_pre]) && spectrumMass[j_pre] <= (spectrumMass[j] + offsent - exactM + deltaL[j_pre])){
+            short int k_pre = spectrumMass[j] + offsent - exactM - spectrumMass[j_pre] + deltaL[j_pre];
+            preFound = true;
+            current_pointer = iter_point;
+            short int t_pre = table.getT(i_pre, j_pre, k_pre);
+            if(t_pre + 1 > 0){
+              if(table.getT(i, j, k) == t_pre + 1){
+                cell_pres.add(k, i_pre, j_pre, k_pre - deltaL[j_pre], exactM, mod_info);
+              }
+              if(table.getT(i, j, k) < t_pre + 1){
+                table.setT(i, j, k, t_pre + 1);
+                cell_pres.add(k, i_pre, j_pre, k_pre - deltaL[j_pre], exactM, mod_info);
+              }
+            }
+            break;
+          }
+          iter_point++;
+        }
+      }
+    }
+  }
+}
+
+// The cells of one row are independent: the threads take j from a shared
+// counter, then thread 0 closes the row in j order while the others wait.
+void GraphAlignSim::computeRowsT(GraphAlignTable & table, int thread_num){
+  std::vector<GraphAlignCellPres> row_pres(spec_ver_num_);
+  std::atomic<int> next_j(0);
+  boost::barrier row_barrier(thread_num);
+  auto worker = [&](int t){
+    for(int i = 0; i < proteo_ver_num_; i++){
+      int j;
+      while((j = next_j.fetch_add(1)) < spec_ver_num_){
+        computeCellT(table, row_pres[j], i, j);
+      }
+      row_barrier.wait();
+      if(t == 0){
+        for(int j = 0; j < spec_ver_num_; j++){
+          table.closeCell(i, j, row_pres[j]);
+        }
+        next_j = 0;
+      }
+      row_barrier.wait();
+    }
+  };
+  boost::thread_group team;
+  for(int t = 1; t < thread_num; t++){
+    team.create_thread([&worker, t](){worker(t);});
+  }
+  worker(0);
+  team.join_all();
+}
+
     static void outputProgressBar(float progress) {
         // 进度条的长度
         int barWidth = 50;
@@ -1193,96 +1232,123 @@ void GraphAlignSim:: computeT_v2(bool case1, double ptm_mass){ //whole spectrum
     }
 
 
-void GraphAlignSim::Quantification(std::vector<std::vector<std::vector<short int>>> & T, std::vector<std::vector<std::vector<std::vector<prePosition>>>> & E){
-  auto vertexMapPtr = std::make_shared<std::unordered_map<std::tuple<int,int,int>, int, hashKey_tuple2>>();
-  AlignmentGraphPtr alignGraph_ptr = std::make_shared<AlignmentGraph>();
-  double max_inten = ConstructBacktrackingGraph(T, E, alignGraph_ptr);
+void GraphAlignSim::Quantification(GraphAlignTable & table){
+  GraphAlignStats & stats = record_ptr_->getStats();
+  GraphAlignBounds bounds;
+  bounds.max_matched_ = getMaxEndT(table);
+  stats.setCount("max_matched", bounds.max_matched_);
+  int prune_reason = graph_align_prune::checkEndCells(mng_ptr_, bounds);
+
+  GraphAlignGraph align_graph;
+  double max_inten = -1;
+  if (prune_reason == graph_align_prune::NONE) {
+    GraphAlignTimer timer(stats, "backtrack_graph");
+    max_inten = ConstructBacktrackingGraph(table, align_graph);
+  }
+  stats.setCount("align_vertices", align_graph.getVertexNum());
+
+  const std::vector<std::pair<PeakPtr, SpecPeakType>> & peak_vec = spec_graph_ptr_->getPeakPtrVec();
+  std::vector<double> intens(peak_vec.size());
+  for (size_t p = 0; p < peak_vec.size(); p++) {
+    intens[p] = peak_vec[p].first->getIntensity();
+  }
+  if (prune_reason == graph_align_prune::NONE && max_inten >= 0) {
+    GraphAlignTimer timer(stats, "prune");
+    prune_reason = graph_align_prune::checkGraph(mng_ptr_, align_graph, intens,
+                                                 proteo_ver_num_ - 1, bounds);
+    stats.setCount("end_paths", bounds.end_path_num_);
+  }
 
-  if(max_inten < 0){
-      std::ofstream outFile;
-      std::string result_file = mng_ptr_->align_result_file_;
-      outFile.open(result_file, std::ios::app);
-      outFile << "alignment not found" << std::endl;
-      outFile.close();
+  if (prune_reason != graph_align_prune::NONE) {
+    outputPruned(prune_reason);
+  } else if(max_inten < 0){
+      record_ptr_->getAlignStream() << "alignment not found" << std::endl;
 
-      result_file = mng_ptr_->protoform_result_file_;
-      outFile.open(result_file,std::ios::app);
-      outFile << "alignment not found" << std::endl;
-      outFile << std::endl;
-      outFile.close();
+      std::ostringstream & proteoform_out = record_ptr_->getProteoformStream();
+      proteoform_out << "alignment not found" << std::endl;
+      proteoform_out << std::endl;
 
-      result_file = mng_ptr_->result_file_;
-      outFile.open(result_file, std::ios::app);
-      outFile  <<  std::endl;
-      outFile.close();
+      record_ptr_->getResultStream() << std::endl;
+      record_ptr_->getResult().found_ = false;
 
   }else {
 
       std::cout << "backtrackinggraph built" << std::endl;
 
-      std::unordered_map<int, std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>>> pair_map;
-      std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>> Q2 = ConstructQ2(alignGraph_ptr, pair_map);
-
-      double min_error = 999999999999;
-      std::vector<std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>>> best_B;
-      double best_perc_a;
-      double best_perc_b;
-      double best_q1;
-      double best_q2;
-      double best_a;
-      double best_b;
-      for (int abund_a = 1; abund_a < 100; abund_a++) {
-//    std::cout<<"abund_a = "<<abund_a<<std::endl;
-          outputProgressBar(float(abund_a) / 100.0);
-          for (double abund_b = 1; abund_b < 100; abund_b++) {
-              double q1 = 0.01 * abund_a * max_inten;
-              double q2 = 0.01 * abund_b * max_inten;
-//      std::cout<<"abund_a = "<<abund_a<<std::endl;
-              int ver_num = num_vertices(*alignGraph_ptr);
-              std::vector<std::vector<double>> D(ver_num, std::vector<double>(ver_num, -1));
-              std::vector<std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>>> B(ver_num,
-                                                                                  std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>>(
-                                                                                          ver_num));
-//      if(abund_a==11 && abund_b==2) {
-              FindTwoPath(D, B, Q2, alignGraph_ptr, pair_map, q1, q2);
-//      }
-//      std::cout<<"error: "<<D[0][0]<<" with abund a,b = "<<abund_a<<","<<abund_b<<std::endl;
-              if ((abund_a == 1 && abund_b == 1) || D[0][0] < min_error) {
-                  min_error = D[0][0];
-                  best_B = B;
-                  best_perc_a = abund_a / (abund_a + abund_b);
-                  best_perc_b = abund_b / (abund_a + abund_b);
-                  best_q1 = q1;
-                  best_q2 = q2;
-                  best_a = abund_a;
-                  best_b = abund_b;
-              }
-              D.clear();
-              B.clear();
-          }
+      GraphAlignTimer pair_timer(stats, "pair_enum");
+      GraphPairTable pair_table(align_graph.getVertexNum());
+      std::vector<int> Q2 = ConstructQ2(align_graph, pair_table);
+      stats.setCount("q2_size", Q2.size());
+
+      int lane_num = mng_ptr_->two_path_lane_num_;
+      int64_t budget = mng_ptr_->getMemBudgetBytes();
+      if (budget > 0) {
+        // the candidates are evaluated in more tiles of fewer lanes
+        budget -= table.getMemBytes() + align_graph.getMemBytes();
+        lane_num = GraphTwoPathBatch::getLaneNum(budget, pair_table.getPairNum(),
+                                                 pair_table.getTotalChildNum(), lane_num);
       }
+      stats.setCount("lanes", lane_num);
+      GraphTwoPathBatch two_path_batch(align_graph, Q2, pair_table, intens,
+                                       proteo_ver_num_ - 1, lane_num);
+      GraphAbundEvalFunc eval_func = [&](const std::vector<std::pair<double, double>> & abunds) {
+        std::vector<double> q1_vec(abunds.size());
+        std::vector<double> q2_vec(abunds.size());
+        for (size_t a = 0; a < abunds.size(); a++) {
+          q1_vec[a] = 0.01 * abunds[a].first * max_inten;
+          q2_vec[a] = 0.01 * abunds[a].second * max_inten;
+        }
+        return two_path_batch.compute(q1_vec, q2_vec);
+      };
+
+      pair_timer.stop();
+
+      GraphAbundSearch abund_search(mng_ptr_->abund_search_mode_,
+                                    mng_ptr_->abund_search_step_,
+                                    mng_ptr_->abund_search_tolerance_);
+      GraphAbundPoint best_point;
+      {
+        GraphAlignTimer timer(stats, "abund_search");
+        best_point = abund_search.search(eval_func);
+      }
+      LOG_DEBUG("abundance search evaluations: " << abund_search.getEvalNum());
+      stats.setCount("abund_evals", abund_search.getEvalNum());
+
+      GraphAlignTimer output_timer(stats, "output");
+
+      double min_error = best_point.error_;
+      double best_a = best_point.abund_a_;
+      double best_b = best_point.abund_b_;
+      double best_perc_a = best_a / (best_a + best_b);
+      double best_perc_b = best_b / (best_a + best_b);
+      double best_q1 = 0.01 * best_a * max_inten;
+      double best_q2 = 0.01 * best_b * max_inten;
+
+      // recompute the back pointers of the best abundance pair only
+      std::vector<double> best_D;
+      std::vector<int> best_B;
+      FindTwoPath(best_D, best_B, Q2, align_graph, pair_table, best_q1, best_q2);
+
       std::cout << std::endl << "min error: " << min_error << ", ab: (" << best_a << "," << best_b << "), abundance: ("
                 << std::fixed << std::setprecision(4) << best_perc_a << "," << best_perc_b << "), intensity: ("
                 << best_q1 << "," << best_q2 << ")" << std::endl;
-      std::ofstream outFile;
-       std::string result_file = mng_ptr_->align_result_file_;
-      outFile.open(result_file, std::ios::app);
-      outFile << "min error: " << min_error << ", abundance: (" << std::fixed << std::setprecision(4) << best_perc_a
-              << "," << best_perc_b << "), intensity: (" << best_q1 << "," << best_q2 << ")" << std::endl;
-      outFile.close();
+      record_ptr_->getAlignStream() << "min error: " << min_error << ", abundance: ("
+          << std::fixed << std::setprecision(4) << best_perc_a
+          << "," << best_perc_b << "), intensity: (" << best_q1 << "," << best_q2 << ")" << std::endl;
 
-      result_file = mng_ptr_->result_file_;
-      outFile.open(result_file, std::ios::app);
-      outFile <<  min_error << "\t";
-      outFile.close();
+      record_ptr_->getResultStream() << min_error << "\t";
+      GraphAlignResult & result = record_ptr_->getResult();
+      result.found_ = true;
+      result.error_ = min_error;
+      result.abund_1_ = best_perc_a;
+      result.abund_2_ = best_perc_b;
+      result.q1_ = best_q1;
+      result.q2_ = best_q2;
 
-      backtracking(best_B, E, alignGraph_ptr);
+      backtracking(best_B, pair_table, table, align_graph);
 
-      result_file = mng_ptr_->result_file_;
-      outFile.open(result_file, std::ios::app);
-      outFile  << std::fixed << std::setprecision(4) << best_perc_a
-              << "\t" << best_perc_b << "\t" << best_q1 << "\t" << best_q2 << std::endl;
-      outFile.close();
+      record_ptr_->getResultStream() << std::fixed << std::setprecision(4) << best_perc_a
+          << "\t" << best_perc_b << "\t" << best_q1 << "\t" << best_q2 << std::endl;
 
   }
   std::cout<<"Quantification Finish"<<std::endl;
@@ -1290,214 +1356,138 @@ void GraphAlignSim::Quantification(std::vector<std::vector<std::vector<short int
 
 
 
-void GraphAlignSim::FindTwoPath(std::vector<std::vector<double>> & D,
-                                std::vector<std::vector<std::pair<Vertex_AGraph,Vertex_AGraph>>> & B,
-                                std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>> & Q2,
-                                AlignmentGraphPtr & alignGraph_ptr,
-                                std::unordered_map<int, std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>>> & pair_map,
+void GraphAlignSim::FindTwoPath(std::vector<double> & D,
+                                std::vector<int> & B,
+                                std::vector<int> & Q2,
+                                GraphAlignGraph & align_graph,
+                                GraphPairTable & pair_table,
                                 double q1, double q2){
 
-  int ver_num = num_vertices(*alignGraph_ptr);
-  std::vector<std::vector<bool>> flag_table(ver_num, std::vector<bool>(ver_num, false));
-  std::vector<std::vector<bool>> cut_table(ver_num, std::vector<bool>(ver_num, false));
+  int pair_num = pair_table.getPairNum();
+  D.assign(pair_num, -1);
+  B.assign(pair_num, -1);
+  std::vector<char> cut_table(pair_num, false);
+  const std::vector<std::pair<PeakPtr, SpecPeakType>> & peak_vec = spec_graph_ptr_->getPeakPtrVec();
+  // Q2 is in topological order, so the children of a pair are computed
+  // before it
   for(int n = Q2.size() - 1; n >= 0; n--){
-//    std::cout<<"n="<<n<<std::endl;
-    std::pair<Vertex_AGraph, Vertex_AGraph> node_pair = Q2[n];
-    int j1 = (*alignGraph_ptr)[Q2[n].first].j_;
-    int j2 = (*alignGraph_ptr)[Q2[n].second].j_;
-    int i1 = (*alignGraph_ptr)[Q2[n].first].i_;
-    int i2 = (*alignGraph_ptr)[Q2[n].second].i_;
-    int idx1 = (*alignGraph_ptr)[Q2[n].first].idx_;
-    int idx2 = (*alignGraph_ptr)[Q2[n].second].idx_;
-    int pair_idx = idx1 * ver_num + idx2;
-
-    if(flag_table[idx1][idx2]){
-            continue;
-    }
+    int pair_id = Q2[n];
+    const std::pair<int, int> & node_pair = pair_table.getPair(pair_id);
+    int j1 = align_graph.getVertex(node_pair.first).j_;
+    int j2 = align_graph.getVertex(node_pair.second).j_;
+    int i1 = align_graph.getVertex(node_pair.first).i_;
+    int i2 = align_graph.getVertex(node_pair.second).i_;
 
     if(i1 == proteo_ver_num_ - 1 && i2 == proteo_ver_num_ - 1){
-      D[idx1][idx2] = 0;
-//      if(j1 != j2){
-//        D[idx1][idx2] = abs(q1 - spec_graph_ptr_->getPeakPtrVec()[j1].first->getIntensity()) + abs(q2 - spec_graph_ptr_->getPeakPtrVec()[j2].first->getIntensity());
-//      }else{
-//        D[idx1][idx2] = abs(spec_graph_ptr_->getPeakPtrVec()[j1].first->getIntensity() - q1 - q2);
-//      }
+      D[pair_id] = 0;
     }else{
-      std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>> pair_vec = pair_map[pair_idx];
-      if(pair_vec.empty()){
-        cut_table[idx1][idx2] = true;
+      int child_begin = pair_table.getChildBegin(pair_id);
+      int child_end = pair_table.getChildEnd(pair_id);
+      if(child_begin == child_end){
+        cut_table[pair_id] = true;
         continue;
       }
 
       double min_error = 999999999999;
       double local_error;
-      std::pair<Vertex_AGraph , Vertex_AGraph> source_pair;
+      int source_id = -1;
       bool cur_cut = true;
 
-      if(n == 0) {
-          for (int ii = 0; ii < pair_vec.size(); ii++) {
-              Vertex_AGraph cur_node1 = pair_vec[ii].first;
-              Vertex_AGraph cur_node2 = pair_vec[ii].second;
-              int cur_idx1 = (*alignGraph_ptr)[cur_node1].idx_;
-              int cur_idx2 = (*alignGraph_ptr)[cur_node2].idx_;
-              if(!cut_table[cur_idx1][cur_idx2]) {
-                  cur_cut = false;
-                  local_error = D[cur_idx1][cur_idx2];
-              }
-              if (ii == 0 || local_error < min_error) {
-                  min_error = local_error;
-                  source_pair = pair_vec[ii];
-              }
+      for (int c = child_begin; c < child_end; c++) {
+          int ii = c - child_begin;
+          int child_id = pair_table.getChild(c);
+          if (cut_table[child_id]) {
+              continue;
           }
-      }else {
-          if (i1 == proteo_ver_num_ - 1 && i2 < proteo_ver_num_ - 1) {
-              for (int ii = 0; ii < pair_vec.size(); ii++) {
-                  Vertex_AGraph cur_node = pair_vec[ii].second;
-                  int cur_idx = (*alignGraph_ptr)[cur_node].idx_;
-                  int cur_i = (*alignGraph_ptr)[cur_node].i_;
-                  if (!cut_table[idx1][cur_idx]) {
-                      cur_cut = false;
-                      if (j1 != j2) {
-                          local_error = D[idx1][cur_idx] +
-                                        abs(spec_graph_ptr_->getPeakPtrVec()[j2].first->getIntensity() - q2) +
-                                        q2 * (cur_i - i2 - 1);
-//                              0 * (cur_i - i2 - 1);
-                      } else {
-                          local_error = D[idx1][cur_idx] -
-                                        abs(spec_graph_ptr_->getPeakPtrVec()[j1].first->getIntensity() - q1) +
-                                        abs(spec_graph_ptr_->getPeakPtrVec()[j1].first->getIntensity() - q1 - q2) +
-                                        q2 * (cur_i - i2 - 1);
-//                              0 * (cur_i - i2 - 1);
-                      }
-                      if (ii == 0 || local_error < min_error) {
-                          min_error = local_error;
-                          source_pair = pair_vec[ii];
-//              source_pair = std::make_pair((*alignGraph_ptr)[pair_vec[ii].first].idx_,
-//                                           (*alignGraph_ptr)[pair_vec[ii].second].idx_);
-                      }
-                  }
-
+          cur_cut = false;
+          const std::pair<int, int> & child_pair = pair_table.getPair(child_id);
+          int cur_i1 = align_graph.getVertex(child_pair.first).i_;
+          int cur_i2 = align_graph.getVertex(child_pair.second).i_;
+          if (n == 0) {
+              local_error = D[child_id];
+          } else if (i1 == proteo_ver_num_ - 1 && i2 < proteo_ver_num_ - 1) {
+              if (j1 != j2) {
+                  local_error = D[child_id] +
+                                abs(peak_vec[j2].first->getIntensity() - q2) +
+                                q2 * (cur_i2 - i2 - 1);
+              } else {
+                  local_error = D[child_id] -
+                                abs(peak_vec[j1].first->getIntensity() - q1) +
+                                abs(peak_vec[j1].first->getIntensity() - q1 - q2) +
+                                q2 * (cur_i2 - i2 - 1);
               }
-          }
-          if (i1 < proteo_ver_num_ - 1 && i2 == proteo_ver_num_ - 1) {
-              for (int ii = 0; ii < pair_vec.size(); ii++) {
-                  Vertex_AGraph cur_node = pair_vec[ii].first;
-                  int cur_idx = (*alignGraph_ptr)[cur_node].idx_;
-                  int cur_i = (*alignGraph_ptr)[cur_node].i_;
-                  if (!cut_table[cur_idx][idx2]) {
-                      cur_cut = false;
-                      if (j1 != j2) {
-                          local_error = D[cur_idx][idx2] +
-                                        abs(spec_graph_ptr_->getPeakPtrVec()[j1].first->getIntensity() - q1) +
-                                        q1 * (cur_i - i1 - 1);
-//                            0 * (cur_i - i1 - 1);
-                      } else {
-                          local_error = D[cur_idx][idx2] -
-                                        abs(spec_graph_ptr_->getPeakPtrVec()[j2].first->getIntensity() - q2) +
-                                        abs(spec_graph_ptr_->getPeakPtrVec()[j1].first->getIntensity() - q1 - q2) +
-                                        q1 * (cur_i - i1 - 1);
-//                                0 * (cur_i - i1 - 1);
-                      }
-                      if (ii == 0 || local_error < min_error) {
-                          min_error = local_error;
-                          source_pair = pair_vec[ii];
-//              source_pair = std::make_pair((*alignGraph_ptr)[pair_vec[ii].first].idx_,
-//                                           (*alignGraph_ptr)[pair_vec[ii].second].idx_);
-                      }
-                  }
+          } else if (i1 < proteo_ver_num_ - 1 && i2 == proteo_ver_num_ - 1) {
+              if (j1 != j2) {
+                  local_error = D[child_id] +
+                                abs(peak_vec[j1].first->getIntensity() - q1) +
+                                q1 * (cur_i1 - i1 - 1);
+              } else {
+                  local_error = D[child_id] -
+                                abs(peak_vec[j2].first->getIntensity() - q2) +
+                                abs(peak_vec[j1].first->getIntensity() - q1 - q2) +
+                                q1 * (cur_i1 - i1 - 1);
               }
-          }
-          if (i1 < proteo_ver_num_ - 1 && i2 < proteo_ver_num_ - 1) {
-              for (int ii = 0; ii < pair_vec.size(); ii++) {
-                  Vertex_AGraph cur_node1 = pair_vec[ii].first;
-                  Vertex_AGraph cur_node2 = pair_vec[ii].second;
-                  int cur_idx1 = (*alignGraph_ptr)[cur_node1].idx_;
-                  int cur_idx2 = (*alignGraph_ptr)[cur_node2].idx_;
-                  int cur_i1 = (*alignGraph_ptr)[cur_node1].i_;
-                  int cur_i2 = (*alignGraph_ptr)[cur_node2].i_;
-                  if (!cut_table[cur_idx1][cur_idx2]) {
-//              std::cout<<ii<<std::endl;
-                      cur_cut = false;
-
-
-                      if (j1 == j2) {
-                          local_error = D[cur_idx1][cur_idx2] +
-                                        abs(spec_graph_ptr_->getPeakPtrVec()[j1].first->getIntensity() - q1 - q2) +
-                                        q1 * (cur_i1 - i1 - 1) + q2 * (cur_i2 - i2 - 1);
-//                            0 * (cur_i1 - i1 - 1) + 0 * (cur_i2 - i2 - 1);
-
-//            std::cout<<local_error<<std::endl;
-                      } else {
-                          if (j1 < j2) {
-                              local_error = D[cur_idx1][idx2] +
-                                            abs(spec_graph_ptr_->getPeakPtrVec()[j1].first->getIntensity() - q1) +
-                                            q1 * (cur_i1 - i1 - 1);
-//                              0 * (cur_i1 - i1 - 1);
-
-                          } else {
-                              local_error = D[idx1][cur_idx2] +
-                                            abs(spec_graph_ptr_->getPeakPtrVec()[j2].first->getIntensity() - q2) +
-                                            q2 * (cur_i2 - i2 - 1);
-//                                0 * (cur_i2 - i2 - 1);
-                          }
-                      }
-
-                      if (ii == 0 || local_error < min_error) {
-                          min_error = local_error;
-                          source_pair = pair_vec[ii];
-                      }
-                  }
+          } else {
+              if (j1 == j2) {
+                  local_error = D[child_id] +
+                                abs(peak_vec[j1].first->getIntensity() - q1 - q2) +
+                                q1 * (cur_i1 - i1 - 1) + q2 * (cur_i2 - i2 - 1);
+              } else if (j1 < j2) {
+                  // only the first path moves, the child is (cur_node1, node2)
+                  local_error = D[child_id] +
+                                abs(peak_vec[j1].first->getIntensity() - q1) +
+                                q1 * (cur_i1 - i1 - 1);
+              } else {
+                  local_error = D[child_id] +
+                                abs(peak_vec[j2].first->getIntensity() - q2) +
+                                q2 * (cur_i2 - i2 - 1);
               }
           }
+          if (ii == 0 || local_error < min_error) {
+              min_error = local_error;
+              source_id = child_id;
+          }
       }
-      cut_table[idx1][idx2] = cur_cut;
-      D[idx1][idx2] = min_error;
-      B[idx1][idx2] = source_pair;
+      cut_table[pair_id] = cur_cut;
+      D[pair_id] = min_error;
+      B[pair_id] = source_id;
     }
-    flag_table[idx1][idx2] = true;
   }
 
 }
 
-void GraphAlignSim::backtracking(std::vector<std::vector<std::pair<Vertex_AGraph,Vertex_AGraph>>> & B, std::vector<std::vector<std::vector<std::vector<prePosition>>>> & E, AlignmentGraphPtr & alignGraph_ptr){
-    std::vector<Vertex_AGraph> path1;
-    std::vector<Vertex_AGraph> path2;
+void GraphAlignSim::backtracking(std::vector<int> & B, GraphPairTable & pair_table, GraphAlignTable & table, GraphAlignGraph & align_graph){
+    std::vector<int> path1;
+    std::vector<int> path2;
 
-    std::pair<int,int> cur_pair = B[0][0];
-    while(!((*alignGraph_ptr)[cur_pair.first].i_ == proteo_ver_num_ - 1 && (*alignGraph_ptr)[cur_pair.second].i_ == proteo_ver_num_ - 1)){
+    // pair id 0 is the start pair (v_0, v_0)
+    int cur_id = B[0];
+    while(cur_id >= 0){
+        std::pair<int, int> cur_pair = pair_table.getPair(cur_id);
         path1.push_back(cur_pair.first);
         path2.push_back(cur_pair.second);
-        int idx1 = (*alignGraph_ptr)[cur_pair.first].idx_;
-        int idx2 = (*alignGraph_ptr)[cur_pair.second].idx_;
-        std::pair<Vertex_AGraph, Vertex_AGraph> source_pair = B[idx1][idx2];
-//        std::pair<Vertex_AGraph,Vertex_AGraph> source_pair = B[cur_pair.first][cur_pair.second];
-        cur_pair = source_pair;
+        if (align_graph.getVertex(cur_pair.first).i_ == proteo_ver_num_ - 1
+            && align_graph.getVertex(cur_pair.second).i_ == proteo_ver_num_ - 1) {
+            break;
+        }
+        cur_id = B[cur_id];
     }
-    path1.push_back(cur_pair.first);
-    path2.push_back(cur_pair.second);
 
 //    std::cout<<"======1251624124="<<std::endl;
 
-    std::ofstream outFile;
-    std::string result_file = mng_ptr_->align_result_file_;
-    outFile.open(result_file,std::ios::app);
+    std::ostringstream & outFile = record_ptr_->getAlignStream();
     outFile<<"===Path1==="<<std::endl;
     outFile<<std::setw(5)<< "Peak" << std::setw(5) << "Node" << "\t" << "Mods" << std::endl;
-    outFile.close();
-    rebuildPath(path1, E, alignGraph_ptr);
+    rebuildPath(path1, table, align_graph);
 
-    outFile.open(result_file,std::ios::app);
     outFile<<"===Path2==="<<std::endl;
     outFile<<std::setw(5)<< "Peak" << std::setw(5) << "Node" << "\t" << "Mods" << std::endl;
-    outFile.close();
-    rebuildPath(path2, E, alignGraph_ptr);
+    rebuildPath(path2, table, align_graph);
 
 }
 
-void GraphAlignSim::rebuildPath(std::vector<Vertex_AGraph> & path, std::vector<std::vector<std::vector<std::vector<prePosition>>>> & E, AlignmentGraphPtr & alignGraph_ptr){
-  std::ofstream outFile;
-  std::string result_file = mng_ptr_->align_result_file_;
-  outFile.open(result_file,std::ios::app);
+void GraphAlignSim::rebuildPath(std::vector<int> & path, GraphAlignTable & table, GraphAlignGraph & align_graph){
+  std::ostringstream & outFile = record_ptr_->getAlignStream();
   std::vector<std::pair<unsigned short, unsigned short>> total_mods;
   for(int n = 0; n < path.size(); n ++) {
     int pre_i, pre_j, pre_k;
@@ -1506,30 +1496,31 @@ void GraphAlignSim::rebuildPath(std::vector<Vertex_AGraph> & path, std::vector<s
       pre_j = 0;
       pre_k = 0;
     } else {
-      pre_i = (*alignGraph_ptr)[path[n - 1]].i_;
-      pre_j = (*alignGraph_ptr)[path[n - 1]].j_;
-      pre_k = (*alignGraph_ptr)[path[n - 1]].k_;
-    }
-    int cur_i = (*alignGraph_ptr)[path[n]].i_;
-    int cur_j = (*alignGraph_ptr)[path[n]].j_;
-    int cur_k = (*alignGraph_ptr)[path[n]].k_;
+      const GraphAlignVertex & pre_v = align_graph.getVertex(path[n - 1]);
+      pre_i = pre_v.i_;
+      pre_j = pre_v.j_;
+      pre_k = pre_v.k_;
+    }
+    const GraphAlignVertex & cur_v = align_graph.getVertex(path[n]);
+    int cur_i = cur_v.i_;
+    int cur_j = cur_v.j_;
+    int cur_k = cur_v.k_;
     int cur_k_value = cur_k - deltaL[cur_j];
-    std::vector<prePosition> preNodes = E[cur_i][cur_j][cur_k];
-    prePosition prepos;
-    for (int m = 0; m < preNodes.size(); m++) {
-      int i_pre = preNodes[m].first.first;
-      int j_pre = preNodes[m].first.second;
-      int k_value = std::get<0>(preNodes[m].second);
-      int k_pre = k_value + deltaL[j_pre];
+    ModListId mod_list_id = ModListPool::EMPTY_ID;
+    for (int m = table.getPreBegin(cur_i, cur_j, cur_k); m < table.getPreEnd(cur_i, cur_j, cur_k); m++) {
+      const GraphAlignPre & pre = table.getPre(m);
+      int i_pre = pre.i_pre_;
+      int j_pre = pre.j_pre_;
+      int k_pre = pre.k_value_ + deltaL[j_pre];
       if (i_pre == pre_i && j_pre == pre_j && k_pre == pre_k) {
-        prepos = preNodes[m];
+        mod_list_id = pre.mod_list_id_;
         break;
       }
     }
-    std::vector<std::pair<unsigned short, unsigned short>> modinfo = std::get<2>(prepos.second);
     outFile<<std::setw(5)<< cur_j << std::setw(5) << cur_i << "\t";
+    const GraphModList & modinfo = mod_list_pool_ptr_->getModList(mod_list_id);
     for(int l = 0; l < modinfo.size(); l++){
-      outFile << "<" << mng_ptr_->ptm_map_[modinfo[l].first]->getName() << "," << modinfo[l].second << ">";
+      outFile << "<" << mng_ptr_->ptm_map_.at(modinfo[l].first)->getName() << "," << modinfo[l].second << ">";
       total_mods.push_back(modinfo[l]);
     }
     outFile << std::endl;
@@ -1537,276 +1528,182 @@ void GraphAlignSim::rebuildPath(std::vector<Vertex_AGraph> & path, std::vector<s
       break;
     }
   }
-  outFile.close();
 
-  result_file = mng_ptr_->protoform_result_file_;
-  outFile.open(result_file,std::ios::app);
+  std::ostringstream & proteoform_out = record_ptr_->getProteoformStream();
   for(int l = 0; l < total_mods.size(); l++){
-    outFile<< "<" << mng_ptr_->ptm_map_[total_mods[l].first]->getName() << "," << total_mods[l].second << ">";
+    proteoform_out<< "<" << mng_ptr_->ptm_map_.at(total_mods[l].first)->getName() << "," << total_mods[l].second << ">";
   }
-  outFile << std::endl;
-  outFile.close();
+  proteoform_out << std::endl;
 
 
-    result_file = mng_ptr_->result_file_;
-    outFile.open(result_file,std::ios::app);
+    std::ostringstream mod_out;
     for(int l = 0; l < total_mods.size(); l++){
-        outFile<< "<" << mng_ptr_->ptm_map_[total_mods[l].first]->getName()<<","<< total_mods[l].second << ">";
+        mod_out<< "<" << mng_ptr_->ptm_map_.at(total_mods[l].first)->getName()<<","<< total_mods[l].second << ">";
     }
-    outFile << "\t";
-    outFile.close();
-
-}
-
+    record_ptr_->getResultStream() << mod_out.str() << "\t";
+    record_ptr_->getResult().mod_strs_.push_back(mod_out.str());
 
-std::vector<Vertex_AGraph> GraphAlignSim::getSourceNodes(Vertex_AGraph & v, AlignmentGraphPtr & alignGraph_ptr){
-  std::vector<Vertex_AGraph> node_list;
-  in_alignEdge_iter in_i, in_end;
-  for(tie(in_i, in_end) = boost::in_edges(v, *alignGraph_ptr); in_i != in_end; ++in_i){
-    Edge_AGraph e = *in_i;
-    Vertex_AGraph source = boost::source(e, *alignGraph_ptr);
-    node_list.emplace_back(source);
-  }
-  return node_list;
 }
 
 
-
-
-std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>> GraphAlignSim::ConstructQ2(AlignmentGraphPtr & alignGraph_ptr, std::unordered_map<int, std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>>> & pair_map){
-//  std::pair<vertex_iter, vertex_iter> vp;
-//  Vertex_AGraph v_start;
-//  for(vp = boost::vertices(*alignGraph_ptr); vp.first != vp.second; ++vp.first){
-//      std::cout<<(*alignGraph_ptr)[*vp.first].i_<<std::endl;
-//    (*alignGraph_ptr)[*vp.first].idx_ = (*alignGraph_ptr)[*vp.first].i_ * spec_ver_num_ + (*alignGraph_ptr)[*vp.first].j_;
-//    if((*alignGraph_ptr)[*vp.first].i_ == 0 && (*alignGraph_ptr)[*vp.first].j_ == 0 && (*alignGraph_ptr)[*vp.first].k_ == 0){
-//      v_start = *vp.first;
-//      break;
-//    }
-//  }
-
-  Vertex_AGraph v_start = vertex(0, *alignGraph_ptr.get());
-
-//  std::cout<<(*alignGraph_ptr)[v_start].i_<<std::endl;
-
-  std::queue<std::pair<Vertex_AGraph, Vertex_AGraph>> Q1;
-  std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>> Q2;
-  Q1.push(std::make_pair(v_start,v_start));
-  while(!Q1.empty()) {
-    std::pair<Vertex_AGraph, Vertex_AGraph> cur_pair = Q1.front();
-    std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>> pair_vec;
-
-    Q1.pop();
-    Q2.push_back(cur_pair);
-    std::vector<Vertex_AGraph> node_list_1 = getSourceNodes(cur_pair.first, alignGraph_ptr);
-    std::vector<Vertex_AGraph> node_list_2 = getSourceNodes(cur_pair.second, alignGraph_ptr);
-
-    if((!node_list_1.empty()) && (!node_list_2.empty())) {
-      if ((*alignGraph_ptr)[cur_pair.first].j_ == (*alignGraph_ptr)[cur_pair.second].j_) {
-        for (int x = 0; x < node_list_1.size(); x++) {
-          for (int y = 0; y < node_list_2.size(); y++) {
-            if (abs((*alignGraph_ptr)[node_list_1[x]].i_ - (*alignGraph_ptr)[node_list_2[y]].i_) <=
-                mng_ptr_->max_head_diff) {
-              Q1.push(std::make_pair(node_list_1[x], node_list_2[y]));
-              pair_vec.push_back(std::make_pair(node_list_1[x], node_list_2[y]));
-            }
-          }
-        }
-      } else {
-        if ((*alignGraph_ptr)[cur_pair.first].j_ > (*alignGraph_ptr)[cur_pair.second].j_) {
-          for (int y = 0; y < node_list_2.size(); y++) {
-            if (abs((*alignGraph_ptr)[cur_pair.first].i_ - (*alignGraph_ptr)[node_list_2[y]].i_) <=
-                mng_ptr_->max_head_diff) {
-              Q1.push(std::make_pair(cur_pair.first, node_list_2[y]));
-              pair_vec.push_back(std::make_pair(cur_pair.first, node_list_2[y]));
-            }
-          }
-        } else {
-          for (int x = 0; x < node_list_1.size(); x++) {
-            if (abs((*alignGraph_ptr)[node_list_1[x]].i_ - (*alignGraph_ptr)[cur_pair.second].i_) <=
-                mng_ptr_->max_head_diff) {
-              Q1.push(std::make_pair(node_list_1[x], cur_pair.second));
-              pair_vec.push_back(std::make_pair(node_list_1[x], cur_pair.second));
-            }
+void GraphAlignSim::expandPair(GraphAlignGraph & align_graph, GraphPairTable & pair_table,
+                               int pair_id, std::vector<int> & child_ids){
+  std::pair<int, int> cur_pair = pair_table.getPair(pair_id);
+  const GraphAlignVertex & cur_v1 = align_graph.getVertex(cur_pair.first);
+  const GraphAlignVertex & cur_v2 = align_graph.getVertex(cur_pair.second);
+  // the sources of the in-edges of the two vertices
+  int begin_1 = align_graph.getInBegin(cur_pair.first);
+  int end_1 = align_graph.getInEnd(cur_pair.first);
+  int begin_2 = align_graph.getInBegin(cur_pair.second);
+  int end_2 = align_graph.getInEnd(cur_pair.second);
+
+  child_ids.clear();
+  if (begin_1 < end_1 && begin_2 < end_2) {
+    if (cur_v1.j_ == cur_v2.j_) {
+      for (int x = begin_1; x < end_1; x++) {
+        int src_1 = align_graph.getInSource(x);
+        for (int y = begin_2; y < end_2; y++) {
+          int src_2 = align_graph.getInSource(y);
+          if (abs(align_graph.getVertex(src_1).i_ - align_graph.getVertex(src_2).i_) <=
+              mng_ptr_->max_head_diff) {
+            child_ids.push_back(pair_table.addPair(src_1, src_2));
           }
         }
       }
-    }else{
-      if(node_list_1.empty() && (!node_list_2.empty())){
-        for (int y = 0; y < node_list_2.size(); y++){
-          Q1.push(std::make_pair(cur_pair.first, node_list_2[y]));
-          pair_vec.push_back(std::make_pair(cur_pair.first, node_list_2[y]));
+    } else if (cur_v1.j_ > cur_v2.j_) {
+      for (int y = begin_2; y < end_2; y++) {
+        int src_2 = align_graph.getInSource(y);
+        if (abs(cur_v1.i_ - align_graph.getVertex(src_2).i_) <= mng_ptr_->max_head_diff) {
+          child_ids.push_back(pair_table.addPair(cur_pair.first, src_2));
         }
       }
-      if((!node_list_1.empty()) && node_list_2.empty()){
-        for (int x = 0; x < node_list_1.size(); x++){
-          Q1.push(std::make_pair(node_list_1[x], cur_pair.second));
-          pair_vec.push_back(std::make_pair(node_list_1[x], cur_pair.second));
+    } else {
+      for (int x = begin_1; x < end_1; x++) {
+        int src_1 = align_graph.getInSource(x);
+        if (abs(align_graph.getVertex(src_1).i_ - cur_v2.i_) <= mng_ptr_->max_head_diff) {
+          child_ids.push_back(pair_table.addPair(src_1, cur_pair.second));
         }
       }
     }
-    int pair_idx = (*alignGraph_ptr)[cur_pair.first].idx_ * num_vertices(*alignGraph_ptr) + (*alignGraph_ptr)[cur_pair.second].idx_;
-    pair_map.insert(std::make_pair(pair_idx, pair_vec));
+  } else if (begin_1 == end_1 && begin_2 < end_2) {
+    for (int y = begin_2; y < end_2; y++) {
+      child_ids.push_back(pair_table.addPair(cur_pair.first, align_graph.getInSource(y)));
+    }
+  } else if (begin_1 < end_1 && begin_2 == end_2) {
+    for (int x = begin_1; x < end_1; x++) {
+      child_ids.push_back(pair_table.addPair(align_graph.getInSource(x), cur_pair.second));
+    }
+  }
+  pair_table.setChildren(pair_id, child_ids);
+}
+
+std::vector<int> GraphAlignSim::ConstructQ2(GraphAlignGraph & align_graph, GraphPairTable & pair_table){
+  // Each pair is expanded once when it is first reached. A depth-first
+  // search finishes a pair after all its children, so the reversed finish
+  // order is a topological order that starts with the root pair (v_0, v_0)
+  // and lists every reachable pair once.
+  std::vector<int> Q2;
+  std::vector<int> child_ids;
+  // 0: not reached, 1: on the stack, 2: finished
+  std::vector<char> state;
+  // pair id and the next child to visit
+  std::vector<std::pair<int, int>> stack;
+  int root_id = pair_table.addPair(0, 0);
+  expandPair(align_graph, pair_table, root_id, child_ids);
+  state.resize(pair_table.getPairNum(), 0);
+  state[root_id] = 1;
+  stack.push_back(std::make_pair(root_id, pair_table.getChildBegin(root_id)));
+  while (!stack.empty()) {
+    int cur_id = stack.back().first;
+    int c = stack.back().second;
+    if (c == pair_table.getChildEnd(cur_id)) {
+      state[cur_id] = 2;
+      Q2.push_back(cur_id);
+      stack.pop_back();
+      continue;
+    }
+    stack.back().second++;
+    int child_id = pair_table.getChild(c);
+    if (state[child_id] != 0) {
+      // pair graph is acyclic, so the child is finished
+      continue;
+    }
+    state[child_id] = 1;
+    expandPair(align_graph, pair_table, child_id, child_ids);
+    state.resize(pair_table.getPairNum(), 0);
+    stack.push_back(std::make_pair(child_id, pair_table.getChildBegin(child_id)));
   }
-  std::cout<<"Q2 built"<<std::endl;
+  std::reverse(Q2.begin(), Q2.end());
+  std::cout<<"Q2 built, pair number: "<<Q2.size()<<std::endl;
   return Q2;
 }
 
 
-double GraphAlignSim::ConstructBacktrackingGraph(std::vector<std::vector<std::vector<short int>>> & T, std::vector<std::vector<std::vector<std::vector<prePosition>>>> & E, AlignmentGraphPtr & alignGraph_ptr) {
+int GraphAlignSim::getMaxEndT(GraphAlignTable & table) {
   int i_n = proteo_ver_num_ - 1;
   int y_m = spectrumMass.size() - 1;
-  std::vector<std::tuple<int, int, int>> endNodes;
-//  for (int y = 0; y < spectrumMass.size(); y++)
-    for (size_t k = 0; k < T[i_n][y_m].size(); k++) {
-      if (T[i_n][y_m][k] >= mng_ptr_->alignment_thresh) {
-        endNodes.push_back(std::make_tuple(i_n, y_m, k));
-      }
-    }
+  int max_t = 0;
+  for (int k = 0; k < table.getKNum(y_m); k++) {
+    max_t = std::max(max_t, static_cast<int>(table.getT(i_n, y_m, k)));
+  }
+  return max_t;
+}
 
-    if(endNodes.empty()){
-        return -1;
-    }
+// The result line keeps the reason in the error column.
+void GraphAlignSim::outputPruned(int reason) {
+  std::string name = graph_align_prune::getReasonName(reason);
+  record_ptr_->getAlignStream() << "alignment pruned: " << name << std::endl;
 
-//  }
-  auto vertexMapPtr = std::make_shared<std::unordered_map<std::tuple<int, int, int>, int, hashKey_tuple2>>();
-  VertexInfo_AGraph v_0(T[0][0][0], 0, 0, 0, 0);
-    int v_0_index = add_vertex(v_0, *alignGraph_ptr.get());
-//    std::cout<<"v_index "<<v_0_index<<", mapindex"<<vertexMapPtr->size()<<std::endl;
-  (*vertexMapPtr).insert(std::make_pair(std::make_tuple(0, 0, 0), vertexMapPtr->size()));
-
-
-
-  std::queue<std::tuple<int, int, int>> node_queue;
-//  int max_T = 0;
-//  int best_node_idx = 0;
-//  for (int i = 0; i < endNodes.size(); i++){
-//    int i1 = std::get<0>(endNodes[i]);
-//    int j1 = std::get<1>(endNodes[i]);
-//    int k1 = std::get<2>(endNodes[i]);
-//    if(T[i1][j1][k1] > max_T){
-//      max_T = T[i1][j1][k1];
-//      best_node_idx = i;
-//    }
-//  }
-//  node_queue.push(endNodes[best_node_idx]);
-//  int i1 = std::get<0>(endNodes[best_node_idx]);
-//  int j1 = std::get<1>(endNodes[best_node_idx]);
-//  int k1 = std::get<2>(endNodes[best_node_idx]);
-//  VertexInfo_AGraph v1(T[i1][j1][k1], i1, j1, k1);
-//  int v_index = add_vertex(v1, *alignGraph_ptr.get());
-//  Vertex_AGraph end_v = vertex(v_index, *alignGraph_ptr.get());
-//  (*alignGraph_ptr)[end_v].idx_ = v_index;
-//  std::cout<<"v_index "<<v_index<<", mapindex"<<vertexMapPtr->size()<<std::endl;
-//  (*vertexMapPtr).insert(std::make_pair(std::make_tuple(i1, j1, k1), vertexMapPtr->size()));
-
-  for (int i = 0; i < endNodes.size(); i++) {
-    node_queue.push(endNodes[i]);
-    int i1 = std::get<0>(endNodes[i]);
-    int j1 = std::get<1>(endNodes[i]);
-    int k1 = std::get<2>(endNodes[i]);
-    VertexInfo_AGraph v1(T[i1][j1][k1], i1, j1, k1);
-      int v_index = add_vertex(v1, *alignGraph_ptr.get());
-      Vertex_AGraph end_v = vertex(v_index, *alignGraph_ptr.get());
-      (*alignGraph_ptr)[end_v].idx_ = v_index;
-//      std::cout<<"v_index "<<v_index<<", mapindex"<<vertexMapPtr->size()<<std::endl;
-    (*vertexMapPtr).insert(std::make_pair(std::make_tuple(i1, j1, k1), vertexMapPtr->size()));
-  }
-
-  double max_inten = BFS_max_inten(node_queue, T, E, alignGraph_ptr, vertexMapPtr);
-
-//    //----------------print out the backtracking graph-------------------------------------
-//
-//    std::cout << "---Backtracking Graph---" << std::endl;
-//    int node_num_ = num_vertices(*alignGraph_ptr.get());
-//    std::cout << "The number of nodes is: " << node_num_ << std::endl;
-//    for(int v = node_num_ - 1; v > 0; v--){
-//
-//      Vertex_AGraph vtx = vertex(v, *alignGraph_ptr.get());
-//      std::cout<<"Node idx: "<< (*alignGraph_ptr)[vtx].idx_<< " T(" << (*alignGraph_ptr)[vtx].i_ << ", " << (*alignGraph_ptr)[vtx].j_ << ", " << (*alignGraph_ptr)[vtx].k_ << ") = " << (*alignGraph_ptr)[vtx].T_<<": ";
-//      Edge_AGraph edge_next;
-//      out_alignEdge_iter out_i, out_end;
-//      for(tie(out_i, out_end) = boost::out_edges(vtx, *alignGraph_ptr); out_i != out_end; ++out_i){
-//        Edge_AGraph e = *out_i;
-//        auto modInfo = (*alignGraph_ptr)[e].ModInfo_;
-//
-//
-//        Vertex_AGraph target = boost::target(e, *alignGraph_ptr);
-//        std::cout<<"Node: "<< (*alignGraph_ptr)[target].idx_<<"with mod: ";
-//          for(int index3 = 0; index3 < modInfo.size(); index3++){
-//              std::cout << "[" << mng_ptr_->ptm_map_[modInfo[index3].first]->getName() << ", " << modInfo[index3].second << "], ";
-//          }
-//      }
-//      std::cout<<std::endl;
-//
-//    }
-//
-//    //----------------print out the backtracking graph-------------------------------------
+  std::ostringstream & proteoform_out = record_ptr_->getProteoformStream();
+  proteoform_out << "alignment pruned: " << name << std::endl;
+  proteoform_out << std::endl;
 
-  return max_inten;
+  record_ptr_->getResultStream() << "pruned:" << name << std::endl;
+  GraphAlignResult & result = record_ptr_->getResult();
+  result.found_ = false;
+  result.prune_reason_ = reason;
+  record_ptr_->getStats().setCount("pruned_" + name, 1);
 }
 
+double GraphAlignSim::ConstructBacktrackingGraph(GraphAlignTable & table, GraphAlignGraph & align_graph) {
+  int i_n = proteo_ver_num_ - 1;
+  int y_m = spectrumMass.size() - 1;
+  std::vector<GraphAlignEndCell> end_cells;
+  for (int k = 0; k < table.getKNum(y_m); k++) {
+    if (table.getT(i_n, y_m, k) >= mng_ptr_->alignment_thresh) {
+      GraphAlignEndCell cell;
+      cell.i_ = i_n;
+      cell.j_ = y_m;
+      cell.k_ = k;
+      end_cells.push_back(cell);
+    }
+  }
+  if (end_cells.empty()) {
+    cons_pair_table_.clear();
+    return -1;
+  }
 
+  if (table.isStorePres()) {
+    align_graph.build(table, deltaL, end_cells);
+  } else {
+    // The predecessors of T are final when a cell is recomputed, so it
+    // gets the same predecessors as in computeTableT.
+    GraphAlignCellPres cell_pres;
+    align_graph.build(table, deltaL, end_cells, [&](int i, int j) {
+      table.resetT(i, j);
+      computeCellT(table, cell_pres, i, j);
+      table.loadPres(i, j, cell_pres);
+    });
+    cons_pair_table_.clear();
+  }
 
-double GraphAlignSim::BFS_max_inten(std::queue<std::tuple<int,int,int>> node_queue,
-                        std::vector<std::vector<std::vector<short int>>> T,
-                        std::vector<std::vector<std::vector<std::vector<prePosition>>>> E,
-                        AlignmentGraphPtr &alignGraph_ptr,
-                        std::shared_ptr<std::unordered_map<std::tuple<int, int, int>, int, toppic::hashKey_tuple2>> &vertexMapPtr){
+  const std::vector<std::pair<PeakPtr, SpecPeakType>> & peak_vec = spec_graph_ptr_->getPeakPtrVec();
   double max_inten = 0;
-  while(!node_queue.empty()){
-    auto node = node_queue.front();
-    node_queue.pop();
-
-    int i = std::get<0>(node);
-    int j = std::get<1>(node);
-    int k = std::get<2>(node);
-    double cur_inten = (spec_graph_ptr_->getPeakPtrVec())[j].first->getIntensity();
-    if(cur_inten > max_inten){
+  for (int v = 1; v < align_graph.getVertexNum(); v++) {
+    double cur_inten = peak_vec[align_graph.getVertex(v).j_].first->getIntensity();
+    if (cur_inten > max_inten) {
       max_inten = cur_inten;
     }
-    if(T[i][j][k] > 1){
-      auto preNodes = E[i][j][k];
-      //std::cout << "1: " << preNodes.size() << std::endl;
-      int ori_index = vertexMapPtr->find(node)->second;
-      for(auto & preNode : preNodes){
-        int i_pre = preNode.first.first;
-        int j_pre = preNode.first.second;
-        int k_value = std::get<0>(preNode.second);
-        int k_pre = k_value + deltaL[j_pre];
-
-        int v_index;
-        if (vertexMapPtr->find(std::make_tuple(i_pre, j_pre, k_pre)) == vertexMapPtr->end())
-        {
-          VertexInfo_AGraph v_info(T[i_pre][j_pre][k_pre], i_pre, j_pre, k_pre);
-          v_index = add_vertex(v_info, *alignGraph_ptr.get());
-          Vertex_AGraph cur_v = vertex(v_index, *alignGraph_ptr.get());
-          (*alignGraph_ptr)[cur_v].idx_ = v_index;
-
-          vertexMapPtr->insert(std::make_pair(std::make_tuple(i_pre, j_pre, k_pre), v_index));
-          node_queue.emplace(i_pre, j_pre, k_pre);
-          //verIndex = verIndex + 1;
-          //should return 'verIndex';
-        }
-        else
-        {
-          v_index = vertexMapPtr->find(std::make_tuple(i_pre, j_pre, k_pre))->second;
-        }
-
-
-        int exactMass = std::get<1>(preNode.second);
-        int blackMass = proteo_graph_ptr_->getSeqMass(i_pre,i); //need to be confirmed
-        auto modInfo = std::get<2>(preNode.second);
-        //std::cout << i_pre << ", " << j_pre << ", " << k_pre << std::endl;
-
-        Vertex_AGraph v_pre = vertex(v_index, *alignGraph_ptr.get());
-        Vertex_AGraph v2 = vertex(ori_index, *alignGraph_ptr.get());
-        EdgeInfo_AGraph edge_info(blackMass, exactMass, std::move(modInfo));
-        add_edge(v2, v_pre, edge_info, *alignGraph_ptr.get());
-
-      }
-    }
-
   }
   return max_inten;
 }
@@ -1881,7 +1778,7 @@ void GraphAlignSim::quantification_case1(std::vector<std::tuple<int, int, int>>
         Vertex_AGraph target = boost::target(edge_next, *alignGraph_ptr);
         std::cout << "   Edge " << index2+1 << ": to T(" << (*alignGraph_ptr)[target].i_ << ", " << (*alignGraph_ptr)[target].j_ << ", " << (*alignGraph_ptr)[target].k_ << ") = " << (*alignGraph_ptr)[target].T_ << "; | ";
         std::cout << "Exact mass is " << (*alignGraph_ptr)[edge_next].exactMass_ << "; | Black mass is " << (*alignGraph_ptr)[edge_next].blackMass_ << "; | Mod infor are ";
-        auto modInfo = (*alignGraph_ptr)[edge_next].ModInfo_;
+        auto modInfo = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[edge_next].mod_list_id_);
         int sum = 0;
         for(int index3 = 0; index3 < modInfo.size(); index3++){
           std::cout << "[" << modInfo[index3].first << ", " << modInfo[index3].second << "], ";
@@ -1969,8 +1866,8 @@ void GraphAlignSim::quantification_case1(std::vector<std::tuple<int, int, int>>
                   info2.clear();
                   auto a = edge(prePath.first.second, endPath.first.second, *(alignGraph_ptr.get()));
                   auto b = edge(prePath.second.second, endPath.second.second, *(alignGraph_ptr.get()));
-                  info1 = (*alignGraph_ptr)[a.first].ModInfo_;
-                  info2 = (*alignGraph_ptr)[b.first].ModInfo_;
+                  info1 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[a.first].mod_list_id_);
+                  info2 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[b.first].mod_list_id_);
                   //std::cout << "666" << std::endl;
                   resultPath.emplace_back(std::make_pair(std::make_tuple((*alignGraph_ptr)[prePath.first.second].i_, (*alignGraph_ptr)[prePath.first.second].j_, (*alignGraph_ptr)[prePath.first.second].k_, info1), std::make_tuple((*alignGraph_ptr)[prePath.second.second].i_, (*alignGraph_ptr)[prePath.second.second].j_, (*alignGraph_ptr)[prePath.second.second].k_, info2)));
                   //std::cout << "777" << std::endl;
@@ -2000,8 +1897,8 @@ void GraphAlignSim::quantification_case1(std::vector<std::tuple<int, int, int>>
                     auto a = edge(prePath.first.second, endPath.first.second, *(alignGraph_ptr.get()));
                     auto b = edge(prePath.second.second, endPath.second.second, *(alignGraph_ptr.get()));
                     //std::cout << a.second << ", " << b.second << std::endl;
-                    info1 = (*alignGraph_ptr)[a.first].ModInfo_;
-                    info2 = (*alignGraph_ptr)[b.first].ModInfo_;
+                    info1 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[a.first].mod_list_id_);
+                    info2 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[b.first].mod_list_id_);
                     //std::cout << "666" << std::endl;
                     resultPath.emplace_back(std::make_pair(std::make_tuple((*alignGraph_ptr)[prePath.first.second].i_, (*alignGraph_ptr)[prePath.first.second].j_, (*alignGraph_ptr)[prePath.first.second].k_, info1), std::make_tuple((*alignGraph_ptr)[prePath.second.second].i_, (*alignGraph_ptr)[prePath.second.second].j_, (*alignGraph_ptr)[prePath.second.second].k_, info2)));
                     //std::cout << "777" << std::endl;
@@ -2156,7 +2053,7 @@ void GraphAlignSim::quantification_case2(std::vector<std::tuple<int, int, int>>
           Vertex_AGraph target = boost::target(edge_next, *alignGraph_ptr);
           std::cout << "   Edge " << index2+1 << ": to T(" << (*alignGraph_ptr)[target].i_ << ", " << (*alignGraph_ptr)[target].j_ << ", " << (*alignGraph_ptr)[target].k_ << ") = " << (*alignGraph_ptr)[target].T_ << "; | ";
           std::cout << "Exact mass is " << (*alignGraph_ptr)[edge_next].exactMass_ << "; | Black mass is " << (*alignGraph_ptr)[edge_next].blackMass_ << "; | Mod infor are ";
-          auto modInfo = (*alignGraph_ptr)[edge_next].ModInfo_;
+          auto modInfo = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[edge_next].mod_list_id_);
           int sum = 0;
           for(int index3 = 0; index3 < modInfo.size(); index3++){
             std::cout << "[" << modInfo[index3].first << ", " << modInfo[index3].second << "], ";
@@ -2522,8 +2419,8 @@ std::pair<std::vector<std::pair<std::tuple<int, int, int, std::vector<std::pair<
     auto b = edge(prePath.second.second, endPath.second.second, *(alignGraph_ptr.get()));
     //std::cout << "p: " << p << std::endl;
     //std::cout << a.second << ", " << b.second << std::endl;
-    info1 = (*alignGraph_ptr)[a.first].ModInfo_;
-    info2 = (*alignGraph_ptr)[b.first].ModInfo_;
+    info1 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[a.first].mod_list_id_);
+    info2 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[b.first].mod_list_id_);
     //std::cout << "666" << std::endl;
     returnValue.emplace_back(std::make_pair(std::make_tuple((*alignGraph_ptr)[prePath.first.second].i_, (*alignGraph_ptr)[prePath.first.second].j_, (*alignGraph_ptr)[prePath.first.second].k_, info1), std::make_tuple((*alignGraph_ptr)[prePath.second.second].i_, (*alignGraph_ptr)[prePath.second.second].j_, (*alignGraph_ptr)[prePath.second.second].k_, info2)));
     //std::cout << "777" << std::endl;
@@ -2568,8 +2465,8 @@ std::pair<std::vector<std::pair<std::tuple<int, int, int, std::vector<std::pair<
     auto a = edge(preNode.second, tempNode, *(alignGraph_ptr.get()));
     //auto b = edge(prePath.second.second, endPath.second.second, *(alignGraph_ptr.get()));
     //std::cout << a.second << std::endl;
-    info1 = (*alignGraph_ptr)[a.first].ModInfo_;
-    //info2 = (*alignGraph_ptr)[b.first].ModInfo_;
+    info1 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[a.first].mod_list_id_);
+    //info2 = mod_list_pool_ptr_->getModList((*alignGraph_ptr)[b.first].mod_list_id_);
     singlePath.emplace_back((*alignGraph_ptr)[preNode.second].i_, (*alignGraph_ptr)[preNode.second].j_, (*alignGraph_ptr)[preNode.second].k_, info1);
     tempNode = preNode.second;
     temp = preNode.first;
@@ -2853,7 +2750,7 @@ void GraphAlignSim::add_all_info(int i, int j, int k,
                               std::vector<std::vector<std::vector<std::vector<prePosition>>>> E, 
                               const AlignmentGraphPtr &alignGraph_ptr,
                               const std::shared_ptr<std::unordered_map<std::tuple<int, int, int>, int, toppic::hashKey_tuple2>> &vertexMapPtr,
-                              int ori_index, int exactMass, int blackMass, std::vector<std::pair<unsigned short, unsigned short>> modInfo){
+                              int ori_index, int exactMass, int blackMass, ModListId modInfo){
   int v_index;
   if (vertexMapPtr->find(std::make_tuple(i, j, k)) == vertexMapPtr->end())
   {
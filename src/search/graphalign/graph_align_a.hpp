@@ -16,6 +16,8 @@
 #ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_A_HPP_
 #define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_A_HPP_
 
+#include <queue>
+
 #include "prsm/prsm.hpp"
 #include "search/oneptmsearch/diagonal_header.hpp"
 #include "search/graph/graph.hpp"
@@ -24,11 +26,17 @@
 #include "search/graphalign/graph_dp_node.hpp"
 #include "search/graphalign/graph_result_node.hpp"
 #include "search/graphalign/graph_align_mng.hpp"
+#include "search/graphalign/graph_align_record.hpp"
+#include "search/graphalign/graph_align_graph.hpp"
+#include "search/graphalign/graph_align_prune.hpp"
+#include "search/graphalign/graph_align_table.hpp"
+#include "search/graphalign/graph_cons_pair_table.hpp"
+#include "search/graphalign/graph_pair_table.hpp"
 
 namespace toppic {
 
 typedef std::vector<std::vector<std::vector<std::vector<std::pair<int, int>>>>> ConsistentPairs;
-typedef std::vector<std::vector<std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,std::vector<std::pair<unsigned short,unsigned short>>>>>>>> NewConsPairs;
+typedef std::vector<std::vector<std::vector<std::pair<unsigned int, std::vector<std::pair<std::pair<unsigned short, unsigned short>,ModListId>>>>>> NewConsPairs;
 typedef std::pair<std::pair<int,Vertex_AGraph>,std::pair<int,Vertex_AGraph>> PrePathInfo;
 
 //typedef std::vector<std::vector<std::vector<std::pair<int,std::vector<std::tuple<short int,short int,short int>>>>>> NewConsPairs;
@@ -51,7 +59,7 @@ struct hashKey_tuple2{
 
 
 
-typedef std::pair<std::pair<unsigned short,unsigned short>,std::tuple<short int, unsigned int, std::vector<std::pair<unsigned short,unsigned short>>>> prePosition;
+typedef std::pair<std::pair<unsigned short,unsigned short>,std::tuple<short int, unsigned int, ModListId>> prePosition;
 
 
 
@@ -59,7 +67,8 @@ typedef std::pair<std::pair<unsigned short,unsigned short>,std::tuple<short int,
 class GraphAlignSim {
  public:
   GraphAlignSim(GraphAlignMngPtr mng_ptr, ProteoGraphPtr proteo_graph_ptr,
-             SpecGraphPtr_sim spec_graph_ptr);
+             SpecGraphPtr_sim spec_graph_ptr, GraphAlignRecordPtr record_ptr,
+             GraphAlignTablePtr table_ptr);
 
   //void process(short prot_start, short spec_start);
   //void process2();
@@ -79,25 +88,35 @@ class GraphAlignSim {
   PrsmPtr geneResult(int s);
 
  private:
+  // runs the stages of TopMGFast one at a time
+  friend class GraphAlignBench;
+
   GraphAlignMngPtr mng_ptr_;
 
+  GraphAlignRecordPtr record_ptr_;
+
+  GraphAlignTablePtr table_ptr_;
+
+  ModListPoolPtr mod_list_pool_ptr_;
+
   ProteoGraphPtr proteo_graph_ptr_;
 
-  MassGraphPtr pg_;
+  ChainGraphPtr pg_;
 
   int proteo_ver_num_;
 
   SpecGraphPtr_sim spec_graph_ptr_;
 
-  MassGraphPtr sg_;
+  ChainGraphPtr sg_;
 
   int spec_ver_num_;
 
   int n_unknown_shift_;
 
-  DistVec spec_dist_;
+  SpecDistTable spec_dist_;
 
-  DistVec2D dist_vec_;
+  // borrowed from the proteoform graph
+  const DistVec2D * dist_vec_ptr_;
 
   ConsistentPairs cons_pairs_;
 
@@ -112,7 +131,7 @@ class GraphAlignSim {
   DiagonalHeaderPtrVec2D diag_headers_2d_; 
   
 
-  NewConsPairs new_cons_pairs_;
+  GraphConsPairTable cons_pair_table_;
 
   std::vector<int> delta;
 
@@ -167,11 +186,15 @@ class GraphAlignSim {
   void getNewConsPair();
 
 
-  void addToNewConsistentPairs(int mass, const std::vector<std::pair<std::pair<int, int>, std::vector<std::pair<unsigned short,unsigned short>>>> & sp_pair_ij,
-                                      const std::vector<std::pair<std::pair<int, int>, std::vector<std::pair<unsigned short,unsigned short>>>> & pg_pair_ij);
+  void addToNewConsistentPairs(int mass, const std::pair<int, int> * sp_pair_ij, int sp_pair_num,
+                                      const std::vector<std::pair<std::pair<int, int>, ModListId>> & pg_pair_ij);
+
 
+  // getDelta_ori or getDelta_ppm, depending on the tolerance model
+  void getDelta();
 
-  void getDelta_complex(double totalMass);
+  // per-peak windows from the ppm tolerance and the type of each peak
+  void getDelta_ppm();
 
   void getDelta_ori();
 
@@ -179,25 +202,46 @@ class GraphAlignSim {
 
   void deleteOverlap_v2();
 
+  // Spectrum distances in the range of the protein distances, widened by
+  // the peak windows. Must be called after deleteOverlap_v2.
+  void getSpecDist();
+
   void computeT_v2(bool case1, double ptm_mass);
 
-  void Quantification(std::vector<std::vector<std::vector<short int>>> & T, std::vector<std::vector<std::vector<std::vector<prePosition>>>> & E);
-  double ConstructBacktrackingGraph(std::vector<std::vector<std::vector<short int>>> & T, std::vector<std::vector<std::vector<std::vector<prePosition>>>> & E, AlignmentGraphPtr & alignGraph_ptr);
-    std::vector<Vertex_AGraph> getSourceNodes(Vertex_AGraph & v, AlignmentGraphPtr & alignGraph_ptr);
-    std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>> ConstructQ2(AlignmentGraphPtr & alignGraph_ptr, std::unordered_map<int, std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>>> & pair_map);
-    double BFS_max_inten(std::queue<std::tuple<int,int,int>> node_queue,
-                         std::vector<std::vector<std::vector<short int>>> T,
-                         std::vector<std::vector<std::vector<std::vector<prePosition>>>> E,
-                         AlignmentGraphPtr &alignGraph_ptr,
-                         std::shared_ptr<std::unordered_map<std::tuple<int, int, int>, int, toppic::hashKey_tuple2>> &vertexMapPtr);
-    void FindTwoPath(std::vector<std::vector<double>> & D,
-                                    std::vector<std::vector<std::pair<Vertex_AGraph,Vertex_AGraph>>> & B,
-                                    std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>> & Q2,
-                                    AlignmentGraphPtr & alignGraph_ptr,
-                                    std::unordered_map<int, std::vector<std::pair<Vertex_AGraph, Vertex_AGraph>>> & pair_map,
-                                    double q1, double q2);
-    void backtracking(std::vector<std::vector<std::pair<Vertex_AGraph,Vertex_AGraph>>> & B, std::vector<std::vector<std::vector<std::vector<prePosition>>>> & E, AlignmentGraphPtr & alignGraph_ptr);
-    void rebuildPath(std::vector<Vertex_AGraph> & path, std::vector<std::vector<std::vector<std::vector<prePosition>>>> & E, AlignmentGraphPtr & alignGraph_ptr);
+  // Fills the T and E tables from the consistent pairs, which are then
+  // released, or kept for the low-memory table until the backtracking
+  // graph is built. Returns false if the table does not fit in the
+  // memory budget.
+  bool computeTableT(GraphAlignTable & table);
+
+  // Chooses whether the table stores the predecessors of all cells.
+  // Returns false if even the low-memory table exceeds the budget.
+  bool planTableMem(bool & store_pres);
+
+  void computeCellT(GraphAlignTable & table, GraphAlignCellPres & cell_pres, int i, int j);
+
+  void computeRowsT(GraphAlignTable & table, int thread_num);
+
+  void Quantification(GraphAlignTable & table);
+  double ConstructBacktrackingGraph(GraphAlignTable & table, GraphAlignGraph & align_graph);
+  // largest T of the end cells
+  int getMaxEndT(GraphAlignTable & table);
+  void outputPruned(int reason);
+
+  void expandPair(GraphAlignGraph & align_graph, GraphPairTable & pair_table,
+                  int pair_id, std::vector<int> & child_ids);
+
+  // pairs reachable from (v_0, v_0), each once, in topological order
+  std::vector<int> ConstructQ2(GraphAlignGraph & align_graph, GraphPairTable & pair_table);
+
+  void FindTwoPath(std::vector<double> & D, std::vector<int> & B, std::vector<int> & Q2,
+                   GraphAlignGraph & align_graph, GraphPairTable & pair_table,
+                   double q1, double q2);
+
+  void backtracking(std::vector<int> & B, GraphPairTable & pair_table, GraphAlignTable & table,
+                    GraphAlignGraph & align_graph);
+
+  void rebuildPath(std::vector<int> & path, GraphAlignTable & table, GraphAlignGraph & align_graph);
 
   void quantification_case1(std::vector<std::tuple<int, int, int>> endNodes, std::vector<std::vector<std::vector<short int>>> T, std::vector<std::vector<std::vector<std::vector<prePosition>>>> E);
 
@@ -207,7 +251,7 @@ class GraphAlignSim {
 //                  std::vector<std::vector<std::vector<std::vector<prePosition>>>> E,
 //                  AlignmentGraphPtr alignGraph_ptr,
 //                  std::shared_ptr<std::unordered_map<std::tuple<int, int, int>, int, toppic::hashKey_tuple>> vertexMapPtr,
-//                  int ori_index, int exactMass, int blackMass, std::vector<std::pair<unsigned short, unsigned short>> modInfo);
+//                  int ori_index, int exactMass, int blackMass, ModListId modInfo);
 
   std::vector<std::vector<std::pair<double, std::pair<int, Vertex_AGraph>>>> buildAdditionPath(AlignmentGraphPtr alignGraph_ptr, int T1, int T2, Vertex_AGraph beginNode1, std::vector<std::vector<Vertex_AGraph>> layers1, double a_inten);
 
@@ -227,7 +271,7 @@ class GraphAlignSim {
                     const AlignmentGraphPtr &alignGraph_ptr,
                     const std::shared_ptr<std::unordered_map<std::tuple<int, int, int>, int, toppic::hashKey_tuple2>> &vertexMapPtr,
                     int ori_index, int exactMass, int blackMass,
-                    std::vector<std::pair<unsigned short, unsigned short>> modInfo);
+                    ModListId modInfo);
   void BFS(std::queue<std::tuple<int,int,int>> node_queue,
            std::vector<std::vector<std::vector<short int>>> T,
            std::vector<std::vector<std::vector<std::vector<prePosition>>>> E,
@@ -0,0 +1,88 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <utility>
+
+#include "search/graphalign/graph_align_graph.hpp"
+
+namespace toppic {
+
+int GraphAlignGraph::addVertex(GraphAlignTable & table, int i, int j, int k) {
+  GraphAlignVertex vertex;
+  vertex.T_ = table.getT(i, j, k);
+  vertex.i_ = i;
+  vertex.j_ = j;
+  vertex.k_ = k;
+  int v = vertices_.size();
+  vertices_.push_back(vertex);
+  cell_vertices_[table.getCellIndex(i, j, k)] = v;
+  return v;
+}
+
+void GraphAlignGraph::build(GraphAlignTable & table, const std::vector<int> & deltaL,
+                            const std::vector<GraphAlignEndCell> & end_cells,
+                            const std::function<void(int, int)> & load_pres) {
+  vertices_.clear();
+  cell_vertices_.assign(table.getCellNum(), -1);
+  addVertex(table, 0, 0, 0);
+  for (size_t e = 0; e < end_cells.size(); e++) {
+    const GraphAlignEndCell & cell = end_cells[e];
+    if (cell_vertices_[table.getCellIndex(cell.i_, cell.j_, cell.k_)] < 0) {
+      addVertex(table, cell.i_, cell.j_, cell.k_);
+    }
+  }
+
+  // Vertices are numbered in the order they are reached, so visiting them
+  // by id is a breadth-first search from the end cells. The origin has
+  // T = 1 and is not expanded.
+  std::vector<std::pair<int, int>> edges;
+  for (int v = 1; v < static_cast<int>(vertices_.size()); v++) {
+    int i = vertices_[v].i_;
+    int j = vertices_[v].j_;
+    int k = vertices_[v].k_;
+    if (vertices_[v].T_ <= 1) {
+      continue;
+    }
+    if (!table.hasPres(i, j)) {
+      load_pres(i, j);
+    }
+    for (int m = table.getPreBegin(i, j, k); m < table.getPreEnd(i, j, k); m++) {
+      const GraphAlignPre & pre = table.getPre(m);
+      int k_pre = pre.k_value_ + deltaL[pre.j_pre_];
+      int u = cell_vertices_[table.getCellIndex(pre.i_pre_, pre.j_pre_, k_pre)];
+      if (u < 0) {
+        u = addVertex(table, pre.i_pre_, pre.j_pre_, k_pre);
+      }
+      // edge v -> u, stored as an in-edge of u
+      edges.push_back(std::make_pair(u, v));
+    }
+  }
+
+  // stable counting sort of the edges by target
+  int ver_num = vertices_.size();
+  in_begin_.assign(ver_num + 1, 0);
+  for (size_t e = 0; e < edges.size(); e++) {
+    in_begin_[edges[e].first + 1]++;
+  }
+  for (int v = 0; v < ver_num; v++) {
+    in_begin_[v + 1] += in_begin_[v];
+  }
+  in_sources_.resize(edges.size());
+  std::vector<int> pos(in_begin_.begin(), in_begin_.end() - 1);
+  for (size_t e = 0; e < edges.size(); e++) {
+    in_sources_[pos[edges[e].first]++] = edges[e].second;
+  }
+}
+
+}  // namespace toppic
@@ -0,0 +1,99 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_GRAPH_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_GRAPH_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "search/graphalign/graph_align_table.hpp"
+
+namespace toppic {
+
+struct GraphAlignVertex {
+  short T_;
+  int i_;
+  int j_;
+  int k_;
+};
+
+// An end cell (i, j, k) of the alignment.
+struct GraphAlignEndCell {
+  int i_;
+  int j_;
+  int k_;
+};
+
+// The backtracking graph of GraphAlignSim::Quantification: the cells of
+// a GraphAlignTable that are reached from the end cells through their
+// predecessors. It is built in one pass by build() and not changed after.
+//
+// Vertex 0 is the origin (0, 0, 0), the end cells follow in the given
+// order and the other cells in the order they are reached. Cells are
+// mapped to vertices by their index in the table, so no hashing is
+// needed. Each edge goes from a cell to one of its predecessors, and
+// only the in-edges are kept: the sources of the in-edges of v are
+// stored in one array from getInBegin(v) to getInEnd(v), in the order
+// the edges were found.
+class GraphAlignGraph {
+ public:
+  GraphAlignGraph() {}
+
+  // In the low-memory mode of the table, load_pres(i, j) is called to
+  // add the predecessors of (i, j) the first time one of its cells is
+  // reached.
+  void build(GraphAlignTable & table, const std::vector<int> & deltaL,
+             const std::vector<GraphAlignEndCell> & end_cells,
+             const std::function<void(int, int)> & load_pres = nullptr);
+
+  int getVertexNum() {return vertices_.size();}
+
+  const GraphAlignVertex & getVertex(int v) {return vertices_[v];}
+
+  int getInBegin(int v) {return in_begin_[v];}
+
+  int getInEnd(int v) {return in_begin_[v + 1];}
+
+  int getInNum(int v) {return in_begin_[v + 1] - in_begin_[v];}
+
+  int getInSource(int e) {return in_sources_[e];}
+
+  int getEdgeNum() {return in_sources_.size();}
+
+  int64_t getMemBytes() {
+    return vertices_.capacity() * sizeof(GraphAlignVertex)
+        + (in_begin_.capacity() + in_sources_.capacity() + cell_vertices_.capacity()) * sizeof(int);
+  }
+
+ private:
+  int addVertex(GraphAlignTable & table, int i, int j, int k);
+
+  std::vector<GraphAlignVertex> vertices_;
+
+  std::vector<int> in_begin_;
+
+  std::vector<int> in_sources_;
+
+  // vertex of each table cell, -1 for cells not in the graph
+  std::vector<int> cell_vertices_;
+};
+
+typedef std::shared_ptr<GraphAlignGraph> GraphAlignGraphPtr;
+
+}  // namespace toppic
+
+#endif
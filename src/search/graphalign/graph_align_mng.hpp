@@ -17,6 +17,7 @@
 #define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_MNG_HPP_
 
 #include <cmath>
+#include <cstdint>
 #include <string>
 
 #include "prsm/prsm_para.hpp"
@@ -70,6 +71,11 @@ class GraphAlignMng {
   std::string align_result_file_;
   std::string protoform_result_file_;
   std::string result_file_;
+  // binary copy of result_file_, empty if binary output is off
+  std::string result_bin_file_;
+  // per task stage times and the run summary, empty if stats are off
+  std::string stats_file_;
+  std::string stats_summary_file_;
   bool use_adjusted_precmass = false;
 
   // set it to 1 for testing
@@ -83,6 +89,53 @@ class GraphAlignMng {
 
   double peak_min_mass_ = 10;
 
+  // GRID, COARSE or GOLDEN, see GraphAbundSearch
+  std::string abund_search_mode_ = "GRID";
+
+  // FIXED uses the same window of 27 units (about 0.1 Da) for all peaks,
+  // PPM derives the window of each peak from the error tolerance and the
+  // type of the peak
+  std::string tolerance_model_ = "FIXED";
+
+  // grid step of the COARSE and GOLDEN searches, in percent of the
+  // maximum peak intensity
+  double abund_search_step_ = 10;
+
+  // the COARSE and GOLDEN searches stop when the search step is below it
+  double abund_search_tolerance_ = 1;
+
+  // number of (q1, q2) candidates evaluated in one traversal of Q2
+  int two_path_lane_num_ = 64;
+
+  // number of threads sharing the T table of one spectrum, on top of the
+  // spectrum-level workers
+  int dp_thread_num_ = 1;
+
+  // memory budget of the proteoform graph cache in MB, 0 disables it
+  int proteo_graph_cache_size_ = 512;
+
+  // also write the results in the binary format of GraphAlignBinWriter
+  bool binary_output_ = false;
+
+  // write the stage times of each task to a JSON lines file
+  bool align_stats_ = false;
+
+  // Bounds of GraphAlignBounds below which the quantification of a
+  // spectrum is skipped, the default values disable the pruning.
+  int prune_min_matched_ = 0;
+
+  double prune_min_inten_cov_ = 0;
+
+  // skip spectra with only one alignment path
+  bool prune_single_path_ = false;
+
+  // memory budget of one worker in MB, 0 means no limit. A spectrum whose
+  // T table does not fit is aligned with the low-memory table, and the
+  // two-path lanes are reduced to fit.
+  int mem_budget_mb_ = 0;
+
+  int64_t getMemBudgetBytes() {return static_cast<int64_t>(mem_budget_mb_) << 20;}
+
   int getIntTolerance() {return std::ceil(error_tolerance_ * convert_ratio_);}
 
   int getIntMaxPtmSumMass() {return std::ceil(max_ptm_sum_mass_ * convert_ratio_);}
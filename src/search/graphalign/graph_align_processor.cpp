@@ -12,8 +12,12 @@
 //See the License for the specific language governing permissions and
 //limitations under the License.
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <fstream>
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -28,6 +32,7 @@
 
 #include "common/util/file_util.hpp"
 #include "common/base/mod_util.hpp"
+#include "common/base/ion_type_base.hpp"
 #include "seq/fasta_sub_util.hpp"
 #include "ms/spec/msalign_util.hpp"
 #include "prsm/prsm_xml_writer.hpp"
@@ -37,270 +42,175 @@
 #include "prsm/simple_prsm_util.hpp"
 #include "prsm/simple_prsm_xml_writer.hpp"
 #include "prsm/simple_prsm_xml_writer_util.hpp"
+#include "search/graph/proteo_graph_cache.hpp"
 #include "search/graph/proteo_graph_reader.hpp"
 #include "search/graph/spec_graph_reader.hpp"
 #include "search/graphalign/graph_align.hpp"
 #include "search/graphalign/graph_align_processor.hpp"
 #include "search/graph/spec_graph_sim.hpp"
 #include "search/graphalign/graph_align_a.hpp"
+#include "search/graphalign/graph_align_record_writer.hpp"
+#include "search/graphalign/graph_align_stats.hpp"
+#include "search/graphalign/graph_align_table.hpp"
+#include "search/graphalign/graph_align_task_queue.hpp"
+#include "search/graphalign/graph_candidate_index.hpp"
 
 
 namespace toppic {
 
 
-std::function<void()> geneTask(GraphAlignMngPtr mng_ptr,
-                               ModPtrVec var_mod_ptr_vec,
-                               ModPtrVec N_mod_ptr_vec,
-                               int spectrum_num, int idx) {
-  return [mng_ptr, var_mod_ptr_vec, N_mod_ptr_vec, spectrum_num, idx]() {
-
+ProteoGraphPtr geneRefProteoGraph(GraphAlignMngPtr mng_ptr, ProteoAnnoPtr proteo_anno_ptr,
+                                  int spec_id, const std::string & ref_raw_seq) {
+  PrsmParaPtr prsm_para_ptr = mng_ptr->prsm_para_ptr_;
+  FastaSeqPtr seq_ptr = std::make_shared<FastaSeq>("sp" + std::to_string(spec_id) + "-RefPeptide",
+                                                   ref_raw_seq);
+  FastaSubSeqPtr sub_seq_ptr = std::make_shared<FastaSubSeq>(seq_ptr, 0,
+                                                             seq_ptr->getAcidPtmPairLen());
+  proteo_anno_ptr->anno(ref_raw_seq, true);
+  ChainGraphPtr graph_ptr = getChainGraphPtr(proteo_anno_ptr, mng_ptr->convert_ratio_);
+  ProteoGraphPtr new_proteo_ptr = std::make_shared<ProteoGraph>(sub_seq_ptr,
+                                                                prsm_para_ptr->getFixModPtrVec(),
+                                                                graph_ptr,
+                                                                proteo_anno_ptr->isNme(),
+                                                                mng_ptr->convert_ratio_,
+                                                                mng_ptr->max_known_mods_,
+                                                                mng_ptr->getIntMaxPtmSumMass(),
+                                                                mng_ptr->proteo_graph_gap_,
+                                                                mng_ptr->var_ptm_in_gap_);
+  std::cout << "PMG built" << std::endl;
+  return new_proteo_ptr;
+}
 
+SpecGraphTemplatePtr geneSpecGraphTemplate(GraphAlignMngPtr mng_ptr, SpectrumSetPtr spec_set_ptr) {
+  PrsmParaPtr prsm_para_ptr = mng_ptr->prsm_para_ptr_;
+  SpParaPtr sp_para_ptr = prsm_para_ptr->getSpParaPtr();
 
+  double nterm_fix_shift;
+  if (prsm_para_ptr->getNtermFixModPtrVec().empty()){
+    nterm_fix_shift = 0;
+  }else{
+    nterm_fix_shift = prsm_para_ptr->getNtermFixModPtrVec()[0]->getShift();
+  }
 
-    std::unordered_map<int,PtmPtr> ptm_map;
-    for(int mm = 0; mm < var_mod_ptr_vec.size(); mm++){
-        PtmPtr ptm = var_mod_ptr_vec[mm]->getModResiduePtr()->getPtmPtr();
-        int mod_id = ptm->getUnimodId();
-        ptm_map.insert(std::make_pair(mod_id, ptm));
+  DeconvMsPtrVec deconv_ms_ptr_vec = spec_set_ptr->getDeconvMsPtrVec();
+  double prec_mono_mass = deconv_ms_ptr_vec[0]->getMsHeaderPtr()->getPrecMonoMass();
+  SpecGraphTemplatePtr template_ptr
+      = std::make_shared<SpecGraphTemplate>(prec_mono_mass, sp_para_ptr->getMinMass(),
+                                            IonTypeBase::getIonTypePtr_PREC()->getShift(),
+                                            nterm_fix_shift, mng_ptr->peak_min_mass_,
+                                            mng_ptr->convert_ratio_);
+  for (size_t i = 0; i < deconv_ms_ptr_vec.size(); i++) {
+    ActivationPtr activation_ptr = deconv_ms_ptr_vec[i]->getMsHeaderPtr()->getActivationPtr();
+    for (size_t j = 0; j < deconv_ms_ptr_vec[i]->size(); j++) {
+      DeconvPeakPtr peak_ptr = deconv_ms_ptr_vec[i]->getPeakPtr(j);
+      template_ptr->addPeak(peak_ptr->getMonoMass(), peak_ptr->getIntensity(),
+                            activation_ptr->getNShift(), activation_ptr->getCShift());
     }
-    mng_ptr->ptm_map_ = ptm_map;
-
-    PrsmParaPtr prsm_para_ptr = mng_ptr->prsm_para_ptr_;
-
-    SpParaPtr sp_para_ptr = prsm_para_ptr->getSpParaPtr();
-      int group_spec_num = prsm_para_ptr->getGroupSpecNum();
-    std::string sp_file_name = prsm_para_ptr->getSpectrumFileName();
-
-      MsAlignReader sp_reader(sp_file_name, group_spec_num,
-                              sp_para_ptr->getActivationPtr(),
-                              sp_para_ptr->getSkipList());
+  }
+  template_ptr->build();
+  return template_ptr;
+}
 
-      SpecGraphReader spec_reader(sp_file_name,
-                                  prsm_para_ptr->getGroupSpecNum(),
-                                  mng_ptr->convert_ratio_,
-                                  sp_para_ptr);
+SpecGraphPtr_sim geneSpecGraph(GraphAlignMngPtr mng_ptr, SpectrumSetPtr spec_set_ptr,
+                               double prec_error) {
+  return geneSpecGraphTemplate(mng_ptr, spec_set_ptr)->geneSpecGraph(prec_error);
+}
 
-      double nterm_fix_shift;
-      if (prsm_para_ptr->getNtermFixModPtrVec().empty()){
-          nterm_fix_shift = 0;
-      }else{
-          nterm_fix_shift = prsm_para_ptr->getNtermFixModPtrVec()[0]->getShift();
-      }
+// proteo_ptr and template_ptr are built by the first offset of a spectrum
+// and reused by the others.
+void alignOneSpectrum(GraphAlignMngPtr mng_ptr, ProteoAnnoPtr proteo_anno_ptr,
+                      ProteoGraphCachePtr graph_cache_ptr, const std::string & setting_key,
+                      GraphAlignTaskPtr task_ptr, double prec_error, ProteoGraphPtr & proteo_ptr,
+                      SpecGraphTemplatePtr & template_ptr,
+                      GraphAlignRecordPtr record_ptr, GraphAlignTablePtr table_ptr) {
+  SpectrumSetPtr spec_set_ptr = task_ptr->getSpectrumSetPtr();
+  const std::string & ref_raw_seq = task_ptr->getRefRawSeq();
+  int spec_id = spec_set_ptr->getSpectrumId();
+  GraphAlignStats & stats = record_ptr->getStats();
+  GraphAlignTimer spectrum_timer(stats, "spectrum");
+  if (proteo_ptr == nullptr) {
+    GraphAlignTimer proteo_timer(stats, "proteo_graph");
+    // spectra of the same reference peptide share one graph
+    proteo_ptr = graph_cache_ptr->get(ref_raw_seq, setting_key, [&]() {
+      return geneRefProteoGraph(mng_ptr, proteo_anno_ptr, spec_id, ref_raw_seq);
+    });
+  }
 
+  if (template_ptr == nullptr) {
+    GraphAlignTimer template_timer(stats, "spec_template");
+    template_ptr = geneSpecGraphTemplate(mng_ptr, spec_set_ptr);
+  }
+  GraphAlignTimer spec_timer(stats, "spec_graph");
+  SpecGraphPtr_sim spec_graph_ptr = template_ptr->geneSpecGraph(prec_error);
+  spec_timer.stop();
+  std::cout << "SMG built" << std::endl;
+
+  GraphAlignPtr_sim graph_align
+      = std::make_shared<GraphAlignSim>(mng_ptr, proteo_ptr, spec_graph_ptr, record_ptr, table_ptr);
+
+  std::string header = "===spectrum id: " + std::to_string(spec_id);
+  // the candidate is given only for spectra with several candidates, so
+  // that the files of single-candidate runs keep their format
+  if (task_ptr->getCandNum() > 1) {
+    header = header + "===candidate: " + std::to_string(task_ptr->getCandIdx()) + " " + ref_raw_seq;
+  }
+  record_ptr->getAlignStream() << header << "===offset: " << prec_error <<"==="<<std::endl;
+  record_ptr->getProteoformStream() << header << "===offset: " << prec_error <<"==="<<std::endl;
+  record_ptr->getResultStream() << spec_id << "\t" << prec_error <<"\t";
+  record_ptr->getResult().spec_id_ = spec_id;
+  record_ptr->getResult().offset_ = prec_error;
+  record_ptr->getResult().cand_idx_ = task_ptr->getCandIdx();
+
+  graph_align->TopMGFast();
+}
 
-      SpectrumSetPtr spec_set_ptr = sp_reader.getNextSpectrumSet(sp_para_ptr)[0];
-      ProteoAnnoPtr proteo_anno_ptr
-              = std::make_shared<ProteoAnno>(prsm_para_ptr->getFixModPtrVec(),
-//                                             prsm_para_ptr->getNtermFixModPtrVec(),
-                                             prsm_para_ptr->getProtModPtrVec(),
-                                             var_mod_ptr_vec,
-                                             N_mod_ptr_vec);
+// Aligns the spectrum of a task with its candidate peptide for each of
+// the precursor mass offsets and writes one record per offset.
+void alignTask(GraphAlignMngPtr mng_ptr, ProteoAnnoPtr proteo_anno_ptr,
+               ProteoGraphCachePtr graph_cache_ptr,
+               const std::string & setting_key, GraphAlignTaskPtr task_ptr,
+               GraphAlignRecordWriterPtr writer_ptr, GraphAlignTablePtr table_ptr) {
+  int spec_id = task_ptr->getSpectrumSetPtr()->getSpectrumId();
+  const std::vector<double> & prec_errors = task_ptr->getPrecErrors();
+  ProteoGraphPtr proteo_ptr;
+  SpecGraphTemplatePtr template_ptr;
+  for (size_t e = 0; e < prec_errors.size(); e++) {
+    std::cout << "===spectrum id: " << spec_id << "===offset: " << prec_errors[e] <<"==="<<std::endl;
+    GraphAlignRecordPtr record_ptr = std::make_shared<GraphAlignRecord>(task_ptr->getTaskIdx() + e);
+    alignOneSpectrum(mng_ptr, proteo_anno_ptr, graph_cache_ptr, setting_key, task_ptr,
+                     prec_errors[e], proteo_ptr, template_ptr, record_ptr, table_ptr);
+    writer_ptr->write(record_ptr);
+  }
+}
 
-      std::string sp_directory = sp_file_name;
-      size_t pos = sp_directory.find_last_of('/');
-      if (pos != std::string::npos) {
-          sp_directory.erase(pos + 1);
-      }
-      mng_ptr->resultpath = sp_directory;
-
-      std::ofstream bgnoutFile;
-      std::string bgn_file = mng_ptr->resultpath + "results.txt";
-      mng_ptr->result_file_ = bgn_file;
-      bgnoutFile.open(bgn_file, std::ios::app);
-//                      outFile << "===spectrum id: " << spec_id << "===" << std::endl;
-      bgnoutFile <<  "ID\toffset\tError\tMod1\tMod2\tAbund1\tAbund2\tq1\tq2\n";
-      bgnoutFile.close();
-
-
-      std::fstream f(sp_directory + "ref_peptide.txt");
-      std::string line;
-      std::vector<std::pair<int, std::string>> ref_peps;
-      while(getline(f,line)){
-          std::vector<std::string> l = str_util::split(line, "\t");
-          int sp_id = std::stoi(l[0]);
-          std::string pep = l[1];
-          pep = pep.substr(0, pep.length() - 1);
-          ref_peps.push_back(std::make_pair(sp_id, pep));
-      }
-      f.close();
-
-      int cnt = 0;
-      clock_t start,end;
-      start = clock();
-      while (spec_set_ptr != nullptr) {
-          cnt += group_spec_num;
-//          if (spec_set_ptr->isValid() && spec_set_ptr->getSpectrumId() == 71) {
-              if (spec_set_ptr->isValid()) {
-              //***** read spectrum
-              int spec_id = spec_set_ptr->getSpectrumId();
-              DeconvMsPtrVec deconv_ms_ptr_vec = spec_set_ptr->getDeconvMsPtrVec();
-              double prec_mono_mass = deconv_ms_ptr_vec[0]->getMsHeaderPtr()->getPrecMonoMass();
-//              SpecGraphPtrVec spec_ptr_vec
-//                      = spec_reader.getNextSpecGraphPtrVec(spec_set_ptr, mng_ptr->prec_error_);
-              std::vector<double> prec_error_vec;
-              double IM = mass_constant::getIsotopeMass();
-              if(mng_ptr->use_adjusted_precmass){
-                  prec_error_vec = {0, -IM, IM};
-              }else{
-                  prec_error_vec = {0};;
-              }
-              for(int ee = 0; ee < prec_error_vec.size(); ee ++) {
-
-                  double adjusted_prec_mono_mass = prec_mono_mass + prec_error_vec[ee];
-
-                  SpectrumSetPtr adjusted_spec_set_ptr
-                          = std::make_shared<SpectrumSet>(deconv_ms_ptr_vec, sp_para_ptr, adjusted_prec_mono_mass);
-                  PrmMsPtrVec ms_two_vec = adjusted_spec_set_ptr->getMsTwoPtrVec();
-
-
-                  std::cout << "===spectrum id: " << spec_id << "===offset: " << prec_error_vec[ee] <<"==="<<std::endl;
-
-                  //***** find ref peptide and build PMG
-                  std::string ref_raw_seq;
-                  bool ref_found = false;
-                  for (int p = 0; p < ref_peps.size(); p++) {
-                      if (ref_peps[p].first == spec_id) {
-                          ref_raw_seq = ref_peps[p].second;
-                          ref_found = true;
-                          break;
-                      }
-                  }
-                  if (ref_found) {
-                      FastaSeqPtr seq_ptr = std::make_shared<FastaSeq>("sp" + std::to_string(spec_id) + "-RefPeptide",
-                                                                       ref_raw_seq);
-                      FastaSubSeqPtr sub_seq_ptr = std::make_shared<FastaSubSeq>(seq_ptr, 0,
-                                                                                 seq_ptr->getAcidPtmPairLen());
-                      proteo_anno_ptr->anno(ref_raw_seq, true);
-                      MassGraphPtr graph_ptr = getMassGraphPtr(proteo_anno_ptr, mng_ptr->convert_ratio_);
-                      ProteoGraphPtr proteo_ptr = std::make_shared<ProteoGraph>(sub_seq_ptr,
-                                                                                prsm_para_ptr->getFixModPtrVec(),
-                                                                                graph_ptr,
-                                                                                proteo_anno_ptr->isNme(),
-                                                                                mng_ptr->convert_ratio_,
-                                                                                mng_ptr->max_known_mods_,
-                                                                                mng_ptr->getIntMaxPtmSumMass(),
-                                                                                mng_ptr->proteo_graph_gap_,
-                                                                                mng_ptr->var_ptm_in_gap_);
-                      std::cout << "PMG built" << std::endl;
-
-                      // add mod prec peak
-//                  std::set<int> prec_mass_set = proteo_ptr->getPrecMassSet();
-                      PrmPeakPtrVec peak_vec = prm_ms::getPrmPeakPtrs(ms_two_vec, sp_para_ptr->getPeakTolerancePtr());
-//                  PrmPeakPtrVec peak_vec = prm_ms::getPrmPeakPtrs_addPrecs(ms_two_vec, sp_para_ptr->getPeakTolerancePtr(),prec_mass_set,mng_ptr->convert_ratio_);
-
-
-                      PrmPeakPtrVec no_nterm_peak_vec;
-                      no_nterm_peak_vec.push_back(peak_vec[0]);
-                      for(int v = 1; v < peak_vec.size();  v++){
-                          double ori_mass = peak_vec[v]->getMonoMass();
-                          double new_mass = ori_mass - nterm_fix_shift;
-                          if(new_mass > mng_ptr->peak_min_mass_) {
-                              peak_vec[v]->setMonoMass(ori_mass - nterm_fix_shift);
-                              no_nterm_peak_vec.push_back(peak_vec[v]);
-                          }
-                      }
-
-                      peak_vec = no_nterm_peak_vec;
-
-
-//                      std::ofstream outFile_peaks;
-//                      std::string peaks_file = mng_ptr->resultpath + "processed_spectrum.txt";
-//                      mng_ptr->protoform_result_file_ = peaks_file;
-//                      outFile_peaks.open(peaks_file, std::ios::app);
-////                      outFile << "===spectrum id: " << spec_id << "===" << std::endl;
-//                      outFile_peaks << "===spectrum id: " << spec_id << "===offset: " << prec_error_vec[ee] <<"==="<<std::endl;
-//                      for(int pe = 0; pe < peak_vec.size();pe++){
-//                          outFile_peaks << pe << '\t' << peak_vec[pe]->getMonoMass() << "\t" << peak_vec[pe]->getIntensity() <<std::endl;
-//                      }
-//                      outFile_peaks.close();
-
-
-
-                      //***** build SMG
-                      std::vector<std::pair<PeakPtr, std::string>> peakVec;
-                      for (int p = 0; p < peak_vec.size(); p++) {
-                          double peakMass = peak_vec[p]->getMonoMass();
-                          double peakInten = peak_vec[p]->getIntensity();
-                          std::string type = peak_vec[p]->getBaseTypePtr()->getName();
-                          Peak cur_peak(peakMass, peakInten);
-                          peakVec.push_back(std::make_pair(std::make_shared<Peak>(cur_peak), type));
-                      }
-                      MassGraphPtr sp_graph_ptr = std::make_shared<MassGraph>();
-                      // add mass 0/start nod
-                      VertexInfo v(0);
-                      add_vertex(v, *sp_graph_ptr.get());
-                      for (size_t i = 1; i < peakVec.size(); i++) {
-                          // add a new node for the prm
-                          VertexInfo cur_v(i);
-                          add_vertex(cur_v, *sp_graph_ptr.get());
-
-                          Vertex v1, v2;
-                          v1 = vertex(i - 1, *sp_graph_ptr.get());
-                          v2 = vertex(i, *sp_graph_ptr.get());
-
-                          double dist = peakVec[i].first->getPosition() - peakVec[i - 1].first->getPosition();
-                          EdgeInfo edge_info(dist, mng_ptr->convert_ratio_);
-                          add_edge(v1, v2, edge_info, *sp_graph_ptr.get());
-                      }
-                      SpecGraphPtr_sim spec_graph_ptr = std::make_shared<SpecGraph_sim>(peakVec, sp_graph_ptr,
-                                                                                        mng_ptr->convert_ratio_);
-
-
-                      std::cout << "SMG built" << std::endl;
-
-                      GraphAlignPtr_sim graph_align
-                              = std::make_shared<GraphAlignSim>(mng_ptr, proteo_ptr, spec_graph_ptr);
-
-
-
-                      std::ofstream outFile;
-                      std::string result_file = mng_ptr->resultpath + "align_results_gap" + std::to_string(mng_ptr->proteo_graph_gap_) + "_head" + std::to_string(mng_ptr->max_head_diff) +  ".txt";
-                      mng_ptr->align_result_file_ = result_file;
-                      outFile.open(result_file, std::ios::app);
-//                      outFile << "===spectrum id: " << spec_id << "===" << std::endl;
-                      outFile << "===spectrum id: " << spec_id << "===offset: " << prec_error_vec[ee] <<"==="<<std::endl;
-                      outFile.close();
-
-                      result_file = mng_ptr->resultpath + "proteoforms_results_gap" + std::to_string(mng_ptr->proteo_graph_gap_) + "_head" + std::to_string(mng_ptr->max_head_diff) +  ".txt";
-                      mng_ptr->protoform_result_file_ = result_file;
-                      outFile.open(result_file, std::ios::app);
-//                      outFile << "===spectrum id: " << spec_id << "===" << std::endl;
-                      outFile << "===spectrum id: " << spec_id << "===offset: " << prec_error_vec[ee] <<"==="<<std::endl;
-                      outFile.close();
-
-
-                      result_file = mng_ptr->resultpath + "results.txt";
-                      mng_ptr->result_file_ = result_file;
-                      outFile.open(result_file, std::ios::app);
-//                      outFile << "===spectrum id: " << spec_id << "===" << std::endl;
-                      outFile <<  spec_id << "\t" << prec_error_vec[ee] <<"\t";
-                      outFile.close();
-
-
-
-                      graph_align->TopMGFast();
-
-
-                      //for (int shift = 0; shift <= mng_ptr->n_unknown_shift_; shift++) {
-                      //  PrsmPtr prsm_ptr = graph_align->geneResult(shift);
-                      //  if (prsm_ptr != nullptr) {
-                      //    writer_ptr->write(prsm_ptr);
-                      //  }
-                      //}
-                      graph_align = nullptr;
-                  }
-              }
-          }
-          spec_set_ptr = sp_reader.getNextSpectrumSet(sp_para_ptr)[0];
-      }//end while
-      end = clock();
-      std::cout<<"total time: "<<(end-start)/CLOCKS_PER_SEC<<"s"<<std::endl;
-
-      std::ofstream outFile;
-      std::string result_file = mng_ptr->resultpath+"align_results.txt";
-      outFile.open(result_file,std::ios::app);
-      outFile<<"total time: "<<(end-start)/CLOCKS_PER_SEC<<"s"<<std::endl;
-      outFile.close();
+// Each worker takes tasks from the shared queue until it is closed and
+// empty, so every spectrum/offset pair is aligned exactly once.
+std::function<void()> geneTask(GraphAlignMngPtr mng_ptr,
+                               ModPtrVec var_mod_ptr_vec,
+                               ModPtrVec N_mod_ptr_vec,
+                               ProteoGraphCachePtr graph_cache_ptr,
+                               std::string setting_key,
+                               GraphAlignTaskQueuePtr queue_ptr,
+                               GraphAlignRecordWriterPtr writer_ptr,
+                               int idx) {
+  return [mng_ptr, var_mod_ptr_vec, N_mod_ptr_vec, graph_cache_ptr, setting_key,
+         queue_ptr, writer_ptr, idx]() {
+    PrsmParaPtr prsm_para_ptr = mng_ptr->prsm_para_ptr_;
+    // ProteoAnno keeps the annotation of the last sequence, so each
+    // worker owns one.
+    ProteoAnnoPtr proteo_anno_ptr
+        = std::make_shared<ProteoAnno>(prsm_para_ptr->getFixModPtrVec(),
+                                       prsm_para_ptr->getProtModPtrVec(),
+                                       var_mod_ptr_vec,
+                                       N_mod_ptr_vec);
+    // the T/E table is reset for each spectrum and keeps its memory
+    GraphAlignTablePtr table_ptr = std::make_shared<GraphAlignTable>();
+    GraphAlignTaskPtr task_ptr = queue_ptr->pop(idx);
+    while (task_ptr != nullptr) {
+      alignTask(mng_ptr, proteo_anno_ptr, graph_cache_ptr, setting_key,
+                task_ptr, writer_ptr, table_ptr);
+      task_ptr = queue_ptr->pop(idx);
+    }
   };
 }
 
@@ -323,7 +233,7 @@ std::function<void()> geneTask_old(GraphAlignMngPtr mng_ptr,
         std::cout << "error!" << std::endl;
         exit(EXIT_FAILURE);
     }
-    std::vector<std::vector<std::pair<PeakPtr, std::string>>> specInfoVec;
+    std::vector<std::vector<std::pair<PeakPtr, SpecPeakType>>> specInfoVec;
     std::string line;
     getline(infile, line);
     getline(infile, line);
@@ -337,8 +247,8 @@ std::function<void()> geneTask_old(GraphAlignMngPtr mng_ptr,
     getline(infile, line);
     getline(infile, line);
     //std::cout << line << std::endl;
-    std::vector<std::pair<PeakPtr, std::string>> peak_vec;
-    peak_vec.push_back(std::make_pair(std::make_shared<Peak>(0.0,0.0), "Original"));
+    std::vector<std::pair<PeakPtr, SpecPeakType>> peak_vec;
+    peak_vec.push_back(std::make_pair(std::make_shared<Peak>(0.0,0.0), SpecPeakType::ZERO));
     while (!infile.eof()){
       if(isdigit(line[0])){
         //std::cout << "here" << std::endl;
@@ -353,13 +263,13 @@ std::function<void()> geneTask_old(GraphAlignMngPtr mng_ptr,
           continue;
         }
         Peak p(peakMass, peakInten);
-        peak_vec.push_back(std::make_pair(std::make_shared<Peak>(p), "Original"));
+        peak_vec.push_back(std::make_pair(std::make_shared<Peak>(p), SpecPeakType::ORIGINAL));
         getline(infile, line);
       }
       else{
         specInfoVec.emplace_back(peak_vec);
         peak_vec.clear();
-        peak_vec.push_back(std::make_pair(std::make_shared<Peak>(0.0,0.0), "Original"));
+        peak_vec.push_back(std::make_pair(std::make_shared<Peak>(0.0,0.0), SpecPeakType::ZERO));
         getline(infile, line);
         getline(infile, line);
         getline(infile, line);
@@ -425,26 +335,16 @@ std::function<void()> geneTask_old(GraphAlignMngPtr mng_ptr,
     ///////////
     //std::cout << "spec:" << specInfoVec.size()<< std::endl;
     for(int j = 0; j < specInfoVec.size(); j++){
-      MassGraphPtr sp_graph_ptr = std::make_shared<MassGraph>();
-      // add mass 0/start nod
-      VertexInfo v(0);
-      add_vertex(v, *sp_graph_ptr.get());
       auto peakVec = specInfoVec[j];
+      ChainGraphPtr sp_graph_ptr = std::make_shared<ChainGraph>(peakVec.size());
       for (size_t i = 1; i < peakVec.size(); i++) {
-        // add a new node for the prm
-        VertexInfo cur_v(i);
-        add_vertex(cur_v, *sp_graph_ptr.get());
-
-        Vertex v1, v2;
-        v1 = vertex(i-1, *sp_graph_ptr.get());
-        v2 = vertex(i, *sp_graph_ptr.get());
-
         double dist = peakVec[i].first->getPosition() - peakVec[i-1].first->getPosition();
         //std::cout << "dist[" << i-1 << "," << i <<"]: " << peakVec[i].first->getPosition() << " - " << peakVec[i-1].first->getPosition() << " = " << dist << std::endl;
 
-        EdgeInfo edge_info(dist, mng_ptr->convert_ratio_);
-        add_edge(v1, v2, edge_info , *sp_graph_ptr.get());
+        int int_dist = static_cast<int>(std::round(dist * mng_ptr->convert_ratio_));
+        sp_graph_ptr->addEdge(i - 1, int_dist, -1, nullptr);
       }
+      sp_graph_ptr->build();
       SpecGraphPtr_sim spec_graph_ptr = std::make_shared<SpecGraph_sim>(peakVec, sp_graph_ptr, mng_ptr->convert_ratio_);
       //specGraphSimPtrVec.push_back(spec_graph_ptr);
       std::cout << "Processing No. " << j+1 << " spectrum." << std::endl;
@@ -463,7 +363,7 @@ std::function<void()> geneTask_old(GraphAlignMngPtr mng_ptr,
             for (size_t q = 0; q < seq_ptr_vec.size(); q++){
             proteo_anno_ptr->anno(seq_ptr_vec[q]->getRawSeq(), seq_ptr_vec[q]->isNTerm());
             //std::cout << "2" << std::endl;
-            MassGraphPtr graph_ptr = getMassGraphPtr(proteo_anno_ptr, mng_ptr->convert_ratio_);
+            ChainGraphPtr graph_ptr = getChainGraphPtr(proteo_anno_ptr, mng_ptr->convert_ratio_);
             //createHash(graph_ptr,seq_name);
             //std::cout << "3" << std::endl;
             ProteoGraphPtr proteo_ptr = std::make_shared<ProteoGraph>(seq_ptr_vec[q],
@@ -477,7 +377,9 @@ std::function<void()> geneTask_old(GraphAlignMngPtr mng_ptr,
                                                                       mng_ptr->var_ptm_in_gap_);
             //std::cout << "333" << std::endl;
             GraphAlignPtr_sim graph_align
-                      = std::make_shared<GraphAlignSim>(mng_ptr, proteo_ptr, spec_graph_ptr);
+                      = std::make_shared<GraphAlignSim>(mng_ptr, proteo_ptr, spec_graph_ptr,
+                                                        std::make_shared<GraphAlignRecord>(0),
+                                                        std::make_shared<GraphAlignTable>());
             //graph_align->process_v2();
             //graph_align->diagonal_v2(813, 0);
             //graph_align->diagonal_v3(813, 0);
@@ -594,17 +496,124 @@ void GraphAlignProcessor::process() {
   //--------filtering end--------------
 
 
-//#if defined (_WIN32) || defined (_WIN64) || defined (__MINGW32__) || defined (__MINGW64__)
+  std::unordered_map<int,PtmPtr> ptm_map;
+  for (size_t mm = 0; mm < var_mod_ptr_vec.size(); mm++) {
+    PtmPtr ptm = var_mod_ptr_vec[mm]->getModResiduePtr()->getPtmPtr();
+    ptm_map.insert(std::make_pair(ptm->getUnimodId(), ptm));
+  }
+  mng_ptr_->ptm_map_ = ptm_map;
+
+  std::string sp_directory = sp_file_name;
+  size_t pos = sp_directory.find_last_of('/');
+  if (pos != std::string::npos) {
+    sp_directory.erase(pos + 1);
+  }
+  mng_ptr_->resultpath = sp_directory;
+  std::string file_suffix = "_gap" + std::to_string(mng_ptr_->proteo_graph_gap_)
+      + "_head" + std::to_string(mng_ptr_->max_head_diff) + ".txt";
+  mng_ptr_->align_result_file_ = sp_directory + "align_results" + file_suffix;
+  mng_ptr_->protoform_result_file_ = sp_directory + "proteoforms_results" + file_suffix;
+  mng_ptr_->result_file_ = sp_directory + "results.txt";
+  if (mng_ptr_->binary_output_) {
+    mng_ptr_->result_bin_file_ = sp_directory + "results.bin";
+  }
+  if (mng_ptr_->align_stats_) {
+    mng_ptr_->stats_file_ = sp_directory + "align_stats.jsonl";
+    mng_ptr_->stats_summary_file_ = sp_directory + "align_stats_summary.json";
+  }
+
+  GraphCandidateIndexPtr cand_index_ptr
+      = std::make_shared<GraphCandidateIndex>(sp_directory + "ref_peptide.txt");
+  std::cout << "Reference peptides: " << cand_index_ptr->getCandidateNum()
+      << " candidates of " << cand_index_ptr->getSpecNum() << " spectra" << std::endl;
+
+  GraphAlignRecordWriterPtr writer_ptr
+      = std::make_shared<GraphAlignRecordWriter>(mng_ptr_->align_result_file_,
+                                                 mng_ptr_->protoform_result_file_,
+                                                 mng_ptr_->result_file_,
+                                                 mng_ptr_->result_bin_file_,
+                                                 mng_ptr_->stats_file_);
+  GraphAlignRecordPtr header_ptr = std::make_shared<GraphAlignRecord>(0);
+  header_ptr->getResultStream() << "ID\toffset\tError\tMod1\tMod2\tAbund1\tAbund2\tq1\tq2\n";
+  writer_ptr->write(header_ptr);
+
+  int thread_num = std::max(mng_ptr_->thread_num_, 1);
+  // a few tasks per worker keep the workers busy without reading the
+  // whole spectrum file into memory
+  GraphAlignTaskQueuePtr queue_ptr
+      = std::make_shared<GraphAlignTaskQueue>(thread_num, thread_num * 4);
+
+  ProteoGraphCachePtr graph_cache_ptr
+      = std::make_shared<ProteoGraphCache>(static_cast<size_t>(mng_ptr_->proteo_graph_cache_size_) << 20);
+  std::string setting_key
+      = ProteoGraphCache::geneSettingKey(prsm_para_ptr->getFixModPtrVec(), var_mod_ptr_vec,
+                                         N_mod_ptr_vec, mng_ptr_->proteo_graph_gap_,
+                                         mng_ptr_->var_ptm_in_gap_, mng_ptr_->max_known_mods_);
+
   std::vector<ThreadPtr> thread_vec;
-  //std::cout << "thread_num_ : " << mng_ptr_->thread_num_ << std::endl;
-  for (int i = 0; i < mng_ptr_->thread_num_; i++) {
-    ThreadPtr thread_ptr = std::make_shared<boost::thread>(geneTask(mng_ptr_, var_mod_ptr_vec, N_mod_ptr_vec, spectrum_num, i));
+  for (int i = 0; i < thread_num; i++) {
+    ThreadPtr thread_ptr = std::make_shared<boost::thread>(geneTask(mng_ptr_, var_mod_ptr_vec, N_mod_ptr_vec,
+                                                                    graph_cache_ptr, setting_key,
+                                                                    queue_ptr, writer_ptr, i));
     thread_vec.push_back(thread_ptr);
   }
 
+  std::vector<double> prec_error_vec;
+  double IM = mass_constant::getIsotopeMass();
+  if (mng_ptr_->use_adjusted_precmass) {
+    prec_error_vec = {0, -IM, IM};
+  } else {
+    prec_error_vec = {0};
+  }
+
+  std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+  // task 0 is the header of the result file
+  int task_idx = 1;
+  int group_spec_num = prsm_para_ptr->getGroupSpecNum();
+  MsAlignReader sp_reader(sp_file_name, group_spec_num,
+                          sp_para_ptr->getActivationPtr(),
+                          sp_para_ptr->getSkipList());
+  SpectrumSetPtr spec_set_ptr = sp_reader.getNextSpectrumSet(sp_para_ptr)[0];
+  while (spec_set_ptr != nullptr) {
+    if (spec_set_ptr->isValid()) {
+      // one task for each candidate of the spectrum; a spectrum without
+      // candidates has no output and is skipped. The offsets of a
+      // candidate are aligned by one worker, which shares the spectrum
+      // preprocessing between them.
+      const std::vector<std::string> & cands
+          = cand_index_ptr->getCandidates(spec_set_ptr->getSpectrumId());
+      for (size_t c = 0; c < cands.size(); c++) {
+        queue_ptr->push(std::make_shared<GraphAlignTask>(task_idx, spec_set_ptr, prec_error_vec,
+                                                         cands[c], c, cands.size()));
+        task_idx += prec_error_vec.size();
+      }
+    }
+    spec_set_ptr = sp_reader.getNextSpectrumSet(sp_para_ptr)[0];
+  }
+  sp_reader.close();
+  queue_ptr->close();
+
   for (size_t i = 0; i < thread_vec.size(); i++) {
     if (thread_vec[i]->joinable()) thread_vec[i]->join();
   }
+  writer_ptr->close();
+  if (mng_ptr_->align_stats_) {
+    GraphAlignStatsSummary & stats_summary = writer_ptr->getStatsSummary();
+    stats_summary.print(std::cout);
+    std::ofstream summary_file(mng_ptr_->stats_summary_file_);
+    summary_file << stats_summary.toJson() << std::endl;
+    summary_file.close();
+  }
+  std::cout << "Proteoform graph cache hits: " << graph_cache_ptr->getHitNum()
+      << ", misses: " << graph_cache_ptr->getMissNum() << std::endl;
+
+  long total_seconds = std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::steady_clock::now() - start_time).count();
+  std::cout << "total time: " << total_seconds << "s" << std::endl;
+  std::ofstream time_file;
+  time_file.open(sp_directory + "align_results.txt", std::ios::app);
+  time_file << "total time: " << total_seconds << "s" << std::endl;
+  time_file.close();
 
   time_t now = time(0);
   tm *ltm = localtime(&now);
@@ -16,11 +16,31 @@
 #ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_PROCESSOR_HPP_
 #define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_PROCESSOR_HPP_
 
+#include <memory>
+#include <string>
+
+#include "ms/spec/spectrum_set.hpp"
 #include "search/graph/graph.hpp"
+#include "search/graph/proteo_anno.hpp"
+#include "search/graph/proteo_graph.hpp"
+#include "search/graph/spec_graph_sim.hpp"
+#include "search/graph/spec_graph_template.hpp"
 #include "search/graphalign/graph_align_mng.hpp"
 
 namespace toppic {
 
+// proteoform mass graph of the reference peptide of a spectrum
+ProteoGraphPtr geneRefProteoGraph(GraphAlignMngPtr mng_ptr, ProteoAnnoPtr proteo_anno_ptr,
+                                  int spec_id, const std::string & ref_raw_seq);
+
+// prm peaks of a spectrum, from which the spectrum mass graph of each
+// precursor mass offset is generated
+SpecGraphTemplatePtr geneSpecGraphTemplate(GraphAlignMngPtr mng_ptr, SpectrumSetPtr spec_set_ptr);
+
+// spectrum mass graph of the prms of a spectrum whose precursor mass is
+// shifted by prec_error
+SpecGraphPtr_sim geneSpecGraph(GraphAlignMngPtr mng_ptr, SpectrumSetPtr spec_set_ptr,
+                               double prec_error);
 
 class GraphAlignProcessor {
  public:
@@ -0,0 +1,112 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+
+#include "search/graphalign/graph_align_prune.hpp"
+
+namespace toppic {
+
+namespace graph_align_prune {
+
+std::string getReasonName(int reason) {
+  switch (reason) {
+    case NONE:
+      return "none";
+    case FEW_MATCHES:
+      return "few_matches";
+    case LOW_COVERAGE:
+      return "low_coverage";
+    case SINGLE_PATH:
+      return "single_path";
+    case MEMORY_LIMIT:
+      return "memory_limit";
+    default:
+      return "unknown";
+  }
+}
+
+double compIntenCoverage(GraphAlignGraph & align_graph, const std::vector<double> & intens) {
+  double total = 0;
+  for (size_t p = 0; p < intens.size(); p++) {
+    total += intens[p];
+  }
+  if (total <= 0) {
+    return 0;
+  }
+  // a peak may be on several vertices with different k
+  std::vector<char> covered(intens.size(), false);
+  double sum = 0;
+  for (int v = 0; v < align_graph.getVertexNum(); v++) {
+    int j = align_graph.getVertex(v).j_;
+    if (!covered[j]) {
+      covered[j] = true;
+      sum += intens[j];
+    }
+  }
+  return sum / total;
+}
+
+int countEndPaths(GraphAlignGraph & align_graph, int end_i, int max_num) {
+  // The in-sources of a vertex have a larger T, so visiting the vertices
+  // by decreasing T visits the sources of each vertex before it.
+  int ver_num = align_graph.getVertexNum();
+  std::vector<int> order(ver_num);
+  for (int v = 0; v < ver_num; v++) {
+    order[v] = v;
+  }
+  std::sort(order.begin(), order.end(), [&](int a, int b) {
+    return align_graph.getVertex(a).T_ > align_graph.getVertex(b).T_;
+  });
+  std::vector<int> path_nums(ver_num, 0);
+  for (int n = 0; n < ver_num; n++) {
+    int v = order[n];
+    if (align_graph.getVertex(v).i_ == end_i) {
+      path_nums[v] = 1;
+      continue;
+    }
+    int num = 0;
+    for (int e = align_graph.getInBegin(v); e < align_graph.getInEnd(v); e++) {
+      num = std::min(max_num, num + path_nums[align_graph.getInSource(e)]);
+    }
+    path_nums[v] = num;
+  }
+  return ver_num > 0 ? path_nums[0] : 0;
+}
+
+int checkEndCells(GraphAlignMngPtr mng_ptr, const GraphAlignBounds & bounds) {
+  // spectra below alignment_thresh are reported as not found
+  if (bounds.max_matched_ >= mng_ptr->alignment_thresh
+      && bounds.max_matched_ < mng_ptr->prune_min_matched_) {
+    return FEW_MATCHES;
+  }
+  return NONE;
+}
+
+int checkGraph(GraphAlignMngPtr mng_ptr, GraphAlignGraph & align_graph,
+               const std::vector<double> & intens, int end_i, GraphAlignBounds & bounds) {
+  bounds.inten_cov_ = compIntenCoverage(align_graph, intens);
+  bounds.end_path_num_ = countEndPaths(align_graph, end_i, 2);
+  if (bounds.inten_cov_ < mng_ptr->prune_min_inten_cov_) {
+    return LOW_COVERAGE;
+  }
+  if (mng_ptr->prune_single_path_ && bounds.end_path_num_ == 1) {
+    return SINGLE_PATH;
+  }
+  return NONE;
+}
+
+}  // namespace graph_align_prune
+
+}  // namespace toppic
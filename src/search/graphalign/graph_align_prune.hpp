@@ -0,0 +1,82 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_PRUNE_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_PRUNE_HPP_
+
+#include <string>
+#include <vector>
+
+#include "search/graphalign/graph_align_graph.hpp"
+#include "search/graphalign/graph_align_mng.hpp"
+
+namespace toppic {
+
+// Cheap bounds of the alignment of a spectrum, computed from the T table
+// and the backtracking graph before the pairs of paths are enumerated.
+struct GraphAlignBounds {
+  // largest number of matched peaks of an end cell
+  int max_matched_ = 0;
+
+  // fraction of the spectrum intensity on the peaks of the backtracking
+  // graph, an upper bound of the intensity both proteoforms can explain
+  double inten_cov_ = 0;
+
+  // number of distinct paths from the origin to the last proteoform
+  // vertex, counted up to 2
+  int end_path_num_ = 0;
+};
+
+// Spectra whose bounds show that quantification cannot give a usable
+// proteoform pair skip the pair enumeration and the abundance search.
+// The reason is kept in the result of the spectrum.
+namespace graph_align_prune {
+
+const int NONE = 0;
+
+// the best end cell matches fewer than prune_min_matched_ peaks
+const int FEW_MATCHES = 1;
+
+// the backtracking graph covers less than prune_min_inten_cov_ of the
+// spectrum intensity
+const int LOW_COVERAGE = 2;
+
+// there is only one alignment path, so the two proteoforms are the same
+const int SINGLE_PATH = 3;
+
+// even the low-memory T table exceeds mem_budget_mb_
+const int MEMORY_LIMIT = 4;
+
+std::string getReasonName(int reason);
+
+// fraction of the total of intens on the peaks of the vertices
+double compIntenCoverage(GraphAlignGraph & align_graph, const std::vector<double> & intens);
+
+// number of paths from vertex 0 that end at a vertex in row end_i,
+// counted up to max_num
+int countEndPaths(GraphAlignGraph & align_graph, int end_i, int max_num);
+
+// checked before the backtracking graph is built
+int checkEndCells(GraphAlignMngPtr mng_ptr, const GraphAlignBounds & bounds);
+
+// fills inten_cov_ and end_path_num_ of bounds, checked before the pairs
+// of paths are enumerated
+int checkGraph(GraphAlignMngPtr mng_ptr, GraphAlignGraph & align_graph,
+               const std::vector<double> & intens, int end_i, GraphAlignBounds & bounds);
+
+}  // namespace graph_align_prune
+
+}  // namespace toppic
+
+#endif
@@ -0,0 +1,94 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_RECORD_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_RECORD_HPP_
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "search/graphalign/graph_align_stats.hpp"
+
+namespace toppic {
+
+// The values of the line of a task in the result file, used for the
+// binary output. spec_id_ is -1 if the task has no line.
+struct GraphAlignResult {
+  int spec_id_ = -1;
+
+  double offset_ = 0;
+
+  // index of the reference peptide in the candidates of the spectrum
+  int cand_idx_ = 0;
+
+  bool found_ = false;
+
+  // graph_align_prune reason if the quantification was skipped
+  int prune_reason_ = 0;
+
+  double error_ = 0;
+
+  // modification strings of the two proteoforms
+  std::vector<std::string> mod_strs_;
+
+  double abund_1_ = 0;
+
+  double abund_2_ = 0;
+
+  double q1_ = 0;
+
+  double q2_ = 0;
+};
+
+// Output of one alignment task. The text for the alignment, proteoform
+// and result files is buffered here and written by GraphAlignRecordWriter,
+// together with the stage times of the task.
+class GraphAlignRecord {
+ public:
+  explicit GraphAlignRecord(int task_idx): task_idx_(task_idx) {}
+
+  int getTaskIdx() {return task_idx_;}
+
+  std::ostringstream & getAlignStream() {return align_stream_;}
+
+  std::ostringstream & getProteoformStream() {return proteoform_stream_;}
+
+  std::ostringstream & getResultStream() {return result_stream_;}
+
+  GraphAlignResult & getResult() {return result_;}
+
+  GraphAlignStats & getStats() {return stats_;}
+
+ private:
+  int task_idx_;
+
+  std::ostringstream align_stream_;
+
+  std::ostringstream proteoform_stream_;
+
+  std::ostringstream result_stream_;
+
+  GraphAlignResult result_;
+
+  GraphAlignStats stats_;
+};
+
+typedef std::shared_ptr<GraphAlignRecord> GraphAlignRecordPtr;
+
+}  // namespace toppic
+
+#endif
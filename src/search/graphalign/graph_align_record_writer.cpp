@@ -0,0 +1,127 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "common/util/logger.hpp"
+#include "search/graphalign/graph_align_record_writer.hpp"
+
+namespace toppic {
+
+GraphAlignRecordWriter::GraphAlignRecordWriter(const std::string & align_file_name,
+                                               const std::string & proteoform_file_name,
+                                               const std::string & result_file_name,
+                                               const std::string & bin_file_name,
+                                               const std::string & stats_file_name):
+    align_buf_(1 << 20),
+    proteoform_buf_(1 << 20),
+    result_buf_(1 << 20),
+    queue_(256),
+    closed_(false) {
+      // the buffers must be set before the files are opened
+      align_file_.rdbuf()->pubsetbuf(align_buf_.data(), align_buf_.size());
+      proteoform_file_.rdbuf()->pubsetbuf(proteoform_buf_.data(), proteoform_buf_.size());
+      result_file_.rdbuf()->pubsetbuf(result_buf_.data(), result_buf_.size());
+      align_file_.open(align_file_name, std::ios::app);
+      proteoform_file_.open(proteoform_file_name, std::ios::app);
+      result_file_.open(result_file_name, std::ios::app);
+      if (bin_file_name != "") {
+        bin_writer_ptr_ = std::make_shared<GraphAlignBinWriter>(bin_file_name);
+      }
+      if (stats_file_name != "") {
+        stats_file_.open(stats_file_name, std::ios::app);
+      }
+      thread_ = boost::thread([this]() {run();});
+    }
+
+GraphAlignRecordWriter::~GraphAlignRecordWriter() {
+  close();
+}
+
+void GraphAlignRecordWriter::write(GraphAlignRecordPtr record_ptr) {
+  queue_.push(new GraphAlignRecordPtr(record_ptr));
+  wait_cond_.notify_one();
+}
+
+void GraphAlignRecordWriter::run() {
+  while (true) {
+    // closed_ is read before the queue is drained, so the records
+    // written before close() are all taken
+    bool closed = closed_;
+    bool received = false;
+    GraphAlignRecordPtr * holder;
+    while (queue_.pop(holder)) {
+      pending_records_[(*holder)->getTaskIdx()] = *holder;
+      delete holder;
+      received = true;
+    }
+    writeReadyRecords();
+    if (closed) {
+      return;
+    }
+    if (!received) {
+      // a notification can be missed between the pop and the wait, so
+      // the wait is bounded
+      boost::unique_lock<boost::mutex> lock(wait_mutex_);
+      wait_cond_.timed_wait(lock, boost::posix_time::milliseconds(10));
+    }
+  }
+}
+
+void GraphAlignRecordWriter::writeReadyRecords() {
+  std::map<int, GraphAlignRecordPtr>::iterator it = pending_records_.begin();
+  while (it != pending_records_.end() && it->first == next_task_idx_) {
+    writeRecord(it->second);
+    next_task_idx_++;
+    it = pending_records_.erase(it);
+  }
+}
+
+void GraphAlignRecordWriter::writeRecord(GraphAlignRecordPtr record_ptr) {
+  align_file_ << record_ptr->getAlignStream().str();
+  proteoform_file_ << record_ptr->getProteoformStream().str();
+  result_file_ << record_ptr->getResultStream().str();
+  if (bin_writer_ptr_ != nullptr && record_ptr->getResult().spec_id_ >= 0) {
+    bin_writer_ptr_->write(record_ptr->getResult());
+  }
+  if (stats_file_.is_open() && !record_ptr->getStats().getStageTimes().empty()) {
+    GraphAlignResult & result = record_ptr->getResult();
+    stats_file_ << record_ptr->getStats().toJson(result.spec_id_, result.offset_) << std::endl;
+    stats_summary_.add(record_ptr->getStats());
+  }
+}
+
+void GraphAlignRecordWriter::close() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  closed_ = true;
+  wait_cond_.notify_one();
+  thread_.join();
+  if (!pending_records_.empty()) {
+    LOG_ERROR("Graph alignment writer: " << pending_records_.size()
+              << " records are missing their predecessors.");
+    for (auto & item : pending_records_) {
+      writeRecord(item.second);
+    }
+    pending_records_.clear();
+  }
+  if (align_file_.is_open()) align_file_.close();
+  if (proteoform_file_.is_open()) proteoform_file_.close();
+  if (result_file_.is_open()) result_file_.close();
+  if (bin_writer_ptr_ != nullptr) bin_writer_ptr_->close();
+  if (stats_file_.is_open()) stats_file_.close();
+}
+
+}  // namespace toppic
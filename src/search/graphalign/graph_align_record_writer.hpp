@@ -0,0 +1,113 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_RECORD_WRITER_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_RECORD_WRITER_HPP_
+
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/lockfree/queue.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "search/graphalign/graph_align_record.hpp"
+#include "search/graphalign/graph_align_result_bin.hpp"
+#include "search/graphalign/graph_align_stats.hpp"
+
+namespace toppic {
+
+// Collects records from the worker threads and appends them to the
+// output files in task order. Workers hand their records to one writer
+// thread through a lock-free queue, so write() never waits for file
+// output. The writer keeps a record that finishes early until all
+// records before it have been written. The files are written through
+// large buffers and flushed when the writer is closed. If a binary file
+// name is given, the result lines are also written to it in the format
+// of GraphAlignBinWriter. If a stats file name is given, the stage times
+// of each task are written to it as one JSON line and added to a run
+// summary.
+class GraphAlignRecordWriter {
+ public:
+  GraphAlignRecordWriter(const std::string & align_file_name,
+                         const std::string & proteoform_file_name,
+                         const std::string & result_file_name,
+                         const std::string & bin_file_name,
+                         const std::string & stats_file_name);
+
+  ~GraphAlignRecordWriter();
+
+  void write(GraphAlignRecordPtr record_ptr);
+
+  // Writes the remaining records and closes the files. write() must not
+  // be called after close().
+  void close();
+
+  // valid after close()
+  GraphAlignStatsSummary & getStatsSummary() {return stats_summary_;}
+
+ private:
+  void run();
+
+  void writeReadyRecords();
+
+  void writeRecord(GraphAlignRecordPtr record_ptr);
+
+  std::vector<char> align_buf_;
+
+  std::vector<char> proteoform_buf_;
+
+  std::vector<char> result_buf_;
+
+  std::ofstream align_file_;
+
+  std::ofstream proteoform_file_;
+
+  std::ofstream result_file_;
+
+  GraphAlignBinWriterPtr bin_writer_ptr_;
+
+  std::ofstream stats_file_;
+
+  GraphAlignStatsSummary stats_summary_;
+
+  // a record is passed as a heap allocated pointer, which the writer
+  // thread deletes
+  boost::lockfree::queue<GraphAlignRecordPtr*> queue_;
+
+  // only used by the writer thread
+  std::map<int, GraphAlignRecordPtr> pending_records_;
+
+  int next_task_idx_ = 0;
+
+  std::atomic<bool> closed_;
+
+  // wakes up the writer thread when it waits for records
+  boost::mutex wait_mutex_;
+
+  boost::condition_variable wait_cond_;
+
+  boost::thread thread_;
+};
+
+typedef std::shared_ptr<GraphAlignRecordWriter> GraphAlignRecordWriterPtr;
+
+}  // namespace toppic
+
+#endif
@@ -0,0 +1,219 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "common/util/logger.hpp"
+#include "search/graphalign/graph_align_prune.hpp"
+#include "search/graphalign/graph_align_result_bin.hpp"
+
+namespace toppic {
+
+namespace graph_align_result_bin {
+
+void convertToTsv(const std::string & bin_file_name, const std::string & tsv_file_name) {
+  GraphAlignBinReader reader(bin_file_name);
+  std::ofstream tsv_file(tsv_file_name);
+  tsv_file << "ID\toffset\tError\tMod1\tMod2\tAbund1\tAbund2\tq1\tq2\n";
+  for (int r = 0; r < reader.getRecordNum(); r++) {
+    const GraphAlignBinRecord & record = reader.getRecord(r);
+    // the same formatting as the result stream of a GraphAlignRecord
+    std::ostringstream line;
+    line << record.spec_id_ << "\t" << record.offset_ << "\t";
+    if (record.found_) {
+      line << record.error_ << "\t"
+          << reader.getString(record.mod_1_id_) << "\t"
+          << reader.getString(record.mod_2_id_) << "\t"
+          << std::fixed << std::setprecision(4) << record.abund_1_
+          << "\t" << record.abund_2_ << "\t" << record.q1_ << "\t" << record.q2_;
+    } else if (record.prune_reason_ != graph_align_prune::NONE) {
+      line << "pruned:" << graph_align_prune::getReasonName(record.prune_reason_);
+    }
+    line << "\n";
+    tsv_file << line.str();
+  }
+  tsv_file.close();
+}
+
+}  // namespace graph_align_result_bin
+
+GraphAlignBinWriter::GraphAlignBinWriter(const std::string & file_name):
+    buf_(1 << 20) {
+      file_.rdbuf()->pubsetbuf(buf_.data(), buf_.size());
+      file_.open(file_name, std::ios::binary | std::ios::trunc);
+      GraphAlignBinHeader header;
+      std::memcpy(header.magic_, graph_align_result_bin::MAGIC, sizeof(header.magic_));
+      header.version_ = graph_align_result_bin::VERSION;
+      header.record_size_ = sizeof(GraphAlignBinRecord);
+      file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      getStringId("");
+    }
+
+GraphAlignBinWriter::~GraphAlignBinWriter() {
+  close();
+}
+
+int32_t GraphAlignBinWriter::getStringId(const std::string & str) {
+  std::unordered_map<std::string, int32_t>::iterator it = string_ids_.find(str);
+  if (it != string_ids_.end()) {
+    return it->second;
+  }
+  int32_t id = strings_.size();
+  string_ids_[str] = id;
+  strings_.push_back(str);
+  return id;
+}
+
+void GraphAlignBinWriter::write(const GraphAlignResult & result) {
+  GraphAlignBinRecord record;
+  std::memset(&record, 0, sizeof(record));
+  record.spec_id_ = result.spec_id_;
+  record.offset_ = result.offset_;
+  record.prune_reason_ = result.prune_reason_;
+  record.cand_idx_ = result.cand_idx_;
+  if (result.found_) {
+    record.found_ = 1;
+    record.error_ = result.error_;
+    record.abund_1_ = result.abund_1_;
+    record.abund_2_ = result.abund_2_;
+    record.q1_ = result.q1_;
+    record.q2_ = result.q2_;
+    record.mod_1_id_ = getStringId(result.mod_strs_.size() > 0 ? result.mod_strs_[0] : "");
+    record.mod_2_id_ = getStringId(result.mod_strs_.size() > 1 ? result.mod_strs_[1] : "");
+  }
+  file_.write(reinterpret_cast<const char*>(&record), sizeof(record));
+
+  if (!index_.empty() && index_.back().spec_id_ == record.spec_id_) {
+    index_.back().record_num_++;
+  } else {
+    GraphAlignBinIndexEntry entry;
+    entry.spec_id_ = record.spec_id_;
+    entry.first_record_ = record_num_;
+    entry.record_num_ = 1;
+    index_.push_back(entry);
+  }
+  record_num_++;
+}
+
+void GraphAlignBinWriter::close() {
+  if (!file_.is_open()) {
+    return;
+  }
+  GraphAlignBinFooter footer;
+  footer.record_offset_ = sizeof(GraphAlignBinHeader);
+  footer.record_num_ = record_num_;
+  footer.string_offset_ = footer.record_offset_ + record_num_ * sizeof(GraphAlignBinRecord);
+  footer.string_num_ = strings_.size();
+  uint64_t string_byte_num = 0;
+  for (size_t s = 0; s < strings_.size(); s++) {
+    uint32_t len = strings_[s].size();
+    file_.write(reinterpret_cast<const char*>(&len), sizeof(len));
+    file_.write(strings_[s].data(), len);
+    string_byte_num += sizeof(len) + len;
+  }
+  // entries of the same spectrum keep their file order
+  std::stable_sort(index_.begin(), index_.end(),
+                   [](const GraphAlignBinIndexEntry & a, const GraphAlignBinIndexEntry & b) {
+                     return a.spec_id_ < b.spec_id_;
+                   });
+  footer.index_offset_ = footer.string_offset_ + string_byte_num;
+  footer.index_num_ = index_.size();
+  if (!index_.empty()) {
+    file_.write(reinterpret_cast<const char*>(index_.data()),
+                index_.size() * sizeof(GraphAlignBinIndexEntry));
+  }
+  std::memcpy(footer.magic_, graph_align_result_bin::MAGIC, sizeof(footer.magic_));
+  file_.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+  file_.close();
+}
+
+GraphAlignBinReader::GraphAlignBinReader(const std::string & file_name) {
+  try {
+    mapping_ = boost::interprocess::file_mapping(file_name.c_str(), boost::interprocess::read_only);
+    region_ = boost::interprocess::mapped_region(mapping_, boost::interprocess::read_only);
+  } catch (std::exception & e) {
+    LOG_ERROR("Binary result file " << file_name << " cannot be mapped: " << e.what());
+    exit(EXIT_FAILURE);
+  }
+  const char * data = static_cast<const char*>(region_.get_address());
+  uint64_t size = region_.get_size();
+  if (size < sizeof(GraphAlignBinHeader) + sizeof(GraphAlignBinFooter)) {
+    LOG_ERROR("Binary result file " << file_name << " is too short!");
+    exit(EXIT_FAILURE);
+  }
+  const GraphAlignBinHeader * header = reinterpret_cast<const GraphAlignBinHeader*>(data);
+  std::memcpy(&footer_, data + size - sizeof(GraphAlignBinFooter), sizeof(footer_));
+  if (std::memcmp(header->magic_, graph_align_result_bin::MAGIC, sizeof(header->magic_)) != 0
+      || std::memcmp(footer_.magic_, graph_align_result_bin::MAGIC, sizeof(footer_.magic_)) != 0) {
+    LOG_ERROR("File " << file_name << " is not a complete binary result file!");
+    exit(EXIT_FAILURE);
+  }
+  if (header->version_ != graph_align_result_bin::VERSION
+      || header->record_size_ != sizeof(GraphAlignBinRecord)) {
+    LOG_ERROR("Binary result file " << file_name << " has version " << header->version_
+              << " and record size " << header->record_size_ << ", which are not supported!");
+    exit(EXIT_FAILURE);
+  }
+  uint64_t body_end = size - sizeof(GraphAlignBinFooter);
+  if (footer_.string_offset_ != footer_.record_offset_ + footer_.record_num_ * sizeof(GraphAlignBinRecord)
+      || footer_.index_offset_ + footer_.index_num_ * sizeof(GraphAlignBinIndexEntry) != body_end
+      || footer_.string_offset_ > footer_.index_offset_) {
+    LOG_ERROR("Binary result file " << file_name << " has an inconsistent footer!");
+    exit(EXIT_FAILURE);
+  }
+  records_ = reinterpret_cast<const GraphAlignBinRecord*>(data + footer_.record_offset_);
+  index_ = reinterpret_cast<const GraphAlignBinIndexEntry*>(data + footer_.index_offset_);
+
+  const char * p = data + footer_.string_offset_;
+  const char * string_end = data + footer_.index_offset_;
+  string_begins_.reserve(footer_.string_num_);
+  string_lens_.reserve(footer_.string_num_);
+  for (uint64_t s = 0; s < footer_.string_num_; s++) {
+    uint32_t len;
+    if (string_end - p < static_cast<int64_t>(sizeof(len))) {
+      break;
+    }
+    std::memcpy(&len, p, sizeof(len));
+    p += sizeof(len);
+    if (string_end - p < static_cast<int64_t>(len)) {
+      break;
+    }
+    string_begins_.push_back(p);
+    string_lens_.push_back(len);
+    p += len;
+  }
+  if (string_begins_.size() != footer_.string_num_ || p != string_end) {
+    LOG_ERROR("Binary result file " << file_name << " has a broken string table!");
+    exit(EXIT_FAILURE);
+  }
+}
+
+bool GraphAlignBinReader::findSpectrum(int spec_id, int & first_record, int & record_num) {
+  const GraphAlignBinIndexEntry * end = index_ + footer_.index_num_;
+  const GraphAlignBinIndexEntry * it
+      = std::lower_bound(index_, end, spec_id,
+                         [](const GraphAlignBinIndexEntry & e, int id) {return e.spec_id_ < id;});
+  if (it == end || it->spec_id_ != spec_id) {
+    return false;
+  }
+  first_record = it->first_record_;
+  record_num = it->record_num_;
+  return true;
+}
+
+}  // namespace toppic
@@ -0,0 +1,180 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_RESULT_BIN_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_RESULT_BIN_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "search/graphalign/graph_align_record.hpp"
+
+namespace toppic {
+
+// Binary form of results.txt, written when topmg runs with
+// --binary-output. Numbers are stored in the byte order of the host,
+// which is little endian on all supported platforms. The file is
+//
+//   header    GraphAlignBinHeader, 16 bytes
+//   records   record_num_ GraphAlignBinRecord of 72 bytes, in the order
+//             of the lines of results.txt
+//   strings   string_num_ modification strings, each a uint32 length
+//             followed by the characters without a terminator
+//   index     index_num_ GraphAlignBinIndexEntry of 12 bytes, sorted by
+//             spectrum id
+//   footer    GraphAlignBinFooter, 56 bytes, at the end of the file
+//
+// A modification string such as "<Phospho,12><Acetyl,3>" is stored once
+// and records refer to it by its position in the string table. String 0
+// is the empty string. The index has one entry for each run of
+// consecutive records of the same spectrum.
+
+struct GraphAlignBinHeader {
+  char magic_[8];
+  uint32_t version_;
+  uint32_t record_size_;
+};
+
+struct GraphAlignBinRecord {
+  int32_t spec_id_;
+  // 0 if no alignment was found, the fields below up to mod_2_id_ are
+  // then 0
+  int32_t found_;
+  // precursor mass offset
+  double offset_;
+  double error_;
+  double abund_1_;
+  double abund_2_;
+  double q1_;
+  double q2_;
+  // ids of the modification strings of the two proteoforms
+  int32_t mod_1_id_;
+  int32_t mod_2_id_;
+  // graph_align_prune reason, 0 if the spectrum was not pruned
+  int32_t prune_reason_;
+  // index of the reference peptide in the candidates of the spectrum,
+  // 0 in files written before multiple candidates were supported
+  int32_t cand_idx_;
+};
+
+struct GraphAlignBinIndexEntry {
+  int32_t spec_id_;
+  uint32_t first_record_;
+  uint32_t record_num_;
+};
+
+struct GraphAlignBinFooter {
+  uint64_t record_offset_;
+  uint64_t record_num_;
+  uint64_t string_offset_;
+  uint64_t string_num_;
+  uint64_t index_offset_;
+  uint64_t index_num_;
+  char magic_[8];
+};
+
+namespace graph_align_result_bin {
+
+const char MAGIC[8] = {'T', 'M', 'G', 'Q', 'R', 'E', 'S', '1'};
+
+const uint32_t VERSION = 2;
+
+// Writes the binary file in the format of results.txt.
+void convertToTsv(const std::string & bin_file_name, const std::string & tsv_file_name);
+
+}  // namespace graph_align_result_bin
+
+// Appends records to a binary result file. The strings and the index are
+// written by close().
+class GraphAlignBinWriter {
+ public:
+  explicit GraphAlignBinWriter(const std::string & file_name);
+
+  ~GraphAlignBinWriter();
+
+  void write(const GraphAlignResult & result);
+
+  void close();
+
+ private:
+  int32_t getStringId(const std::string & str);
+
+  std::vector<char> buf_;
+
+  std::ofstream file_;
+
+  uint64_t record_num_ = 0;
+
+  std::vector<std::string> strings_;
+
+  std::unordered_map<std::string, int32_t> string_ids_;
+
+  std::vector<GraphAlignBinIndexEntry> index_;
+};
+
+typedef std::shared_ptr<GraphAlignBinWriter> GraphAlignBinWriterPtr;
+
+// Memory maps a binary result file. Records, strings and the index are
+// read in place.
+class GraphAlignBinReader {
+ public:
+  explicit GraphAlignBinReader(const std::string & file_name);
+
+  int getRecordNum() {return footer_.record_num_;}
+
+  const GraphAlignBinRecord & getRecord(int r) {return records_[r];}
+
+  int getStringNum() {return string_begins_.size();}
+
+  std::string getString(int id) {
+    return std::string(string_begins_[id], string_lens_[id]);
+  }
+
+  int getIndexNum() {return footer_.index_num_;}
+
+  const GraphAlignBinIndexEntry & getIndexEntry(int e) {return index_[e];}
+
+  // Finds the records of a spectrum with a binary search of the index.
+  // Returns false if the spectrum has no records.
+  bool findSpectrum(int spec_id, int & first_record, int & record_num);
+
+ private:
+  boost::interprocess::file_mapping mapping_;
+
+  boost::interprocess::mapped_region region_;
+
+  GraphAlignBinFooter footer_;
+
+  const GraphAlignBinRecord * records_ = nullptr;
+
+  const GraphAlignBinIndexEntry * index_ = nullptr;
+
+  // the string table is scanned once to find where each string starts
+  std::vector<const char *> string_begins_;
+
+  std::vector<uint32_t> string_lens_;
+};
+
+typedef std::shared_ptr<GraphAlignBinReader> GraphAlignBinReaderPtr;
+
+}  // namespace toppic
+
+#endif
@@ -0,0 +1,172 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+#include "search/graphalign/graph_align_stats.hpp"
+
+namespace toppic {
+
+void GraphAlignStats::addTime(const std::string & name, double wall_ms, double cpu_ms) {
+  for (size_t s = 0; s < stage_times_.size(); s++) {
+    if (stage_times_[s].name_ == name) {
+      stage_times_[s].wall_ms_ += wall_ms;
+      stage_times_[s].cpu_ms_ += cpu_ms;
+      stage_times_[s].call_num_++;
+      return;
+    }
+  }
+  GraphAlignStageTime stage_time;
+  stage_time.name_ = name;
+  stage_time.wall_ms_ = wall_ms;
+  stage_time.cpu_ms_ = cpu_ms;
+  stage_time.call_num_ = 1;
+  stage_times_.push_back(stage_time);
+}
+
+void GraphAlignStats::setCount(const std::string & name, long value) {
+  for (size_t c = 0; c < counts_.size(); c++) {
+    if (counts_[c].first == name) {
+      counts_[c].second = value;
+      return;
+    }
+  }
+  counts_.push_back(std::make_pair(name, value));
+}
+
+std::string GraphAlignStats::toJson(int spec_id, double offset) {
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision(3);
+  ss << "{\"spec_id\":" << spec_id << ",\"offset\":" << offset << ",\"stages\":{";
+  for (size_t s = 0; s < stage_times_.size(); s++) {
+    if (s > 0) ss << ",";
+    ss << "\"" << stage_times_[s].name_ << "\":{\"wall_ms\":" << stage_times_[s].wall_ms_
+        << ",\"cpu_ms\":" << stage_times_[s].cpu_ms_
+        << ",\"calls\":" << stage_times_[s].call_num_ << "}";
+  }
+  ss << "},\"counts\":{";
+  for (size_t c = 0; c < counts_.size(); c++) {
+    if (c > 0) ss << ",";
+    ss << "\"" << counts_[c].first << "\":" << counts_[c].second;
+  }
+  ss << "}}";
+  return ss.str();
+}
+
+GraphAlignTimer::GraphAlignTimer(GraphAlignStats & stats, const std::string & name):
+    stats_(stats),
+    name_(name),
+    wall_start_(std::chrono::steady_clock::now()),
+    cpu_start_(getThreadCpuMs()) {}
+
+GraphAlignTimer::~GraphAlignTimer() {
+  stop();
+}
+
+void GraphAlignTimer::stop() {
+  if (stopped_) {
+    return;
+  }
+  stopped_ = true;
+  double wall_ms = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - wall_start_).count();
+  stats_.addTime(name_, wall_ms, getThreadCpuMs() - cpu_start_);
+}
+
+double GraphAlignTimer::getThreadCpuMs() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+  }
+#endif
+  return 0;
+}
+
+void GraphAlignStatsSummary::add(GraphAlignStats & stats) {
+  task_num_++;
+  const std::vector<GraphAlignStageTime> & stage_times = stats.getStageTimes();
+  for (size_t s = 0; s < stage_times.size(); s++) {
+    size_t t = 0;
+    while (t < stages_.size() && stages_[t].name_ != stage_times[s].name_) {
+      t++;
+    }
+    if (t == stages_.size()) {
+      stages_.push_back(StageSum());
+      stages_[t].name_ = stage_times[s].name_;
+    }
+    stages_[t].wall_ms_ += stage_times[s].wall_ms_;
+    stages_[t].cpu_ms_ += stage_times[s].cpu_ms_;
+    if (stage_times[s].wall_ms_ > stages_[t].max_wall_ms_) {
+      stages_[t].max_wall_ms_ = stage_times[s].wall_ms_;
+    }
+    stages_[t].task_num_++;
+  }
+  const std::vector<std::pair<std::string, long>> & counts = stats.getCounts();
+  for (size_t c = 0; c < counts.size(); c++) {
+    size_t t = 0;
+    while (t < counts_.size() && counts_[t].name_ != counts[c].first) {
+      t++;
+    }
+    if (t == counts_.size()) {
+      counts_.push_back(CountSum());
+      counts_[t].name_ = counts[c].first;
+    }
+    counts_[t].sum_ += counts[c].second;
+    if (counts[c].second > counts_[t].max_) {
+      counts_[t].max_ = counts[c].second;
+    }
+  }
+}
+
+std::string GraphAlignStatsSummary::toJson() {
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision(3);
+  ss << "{\"task_num\":" << task_num_ << ",\"stages\":{";
+  for (size_t s = 0; s < stages_.size(); s++) {
+    if (s > 0) ss << ",";
+    ss << "\"" << stages_[s].name_ << "\":{\"wall_ms\":" << stages_[s].wall_ms_
+        << ",\"cpu_ms\":" << stages_[s].cpu_ms_
+        << ",\"max_wall_ms\":" << stages_[s].max_wall_ms_
+        << ",\"tasks\":" << stages_[s].task_num_ << "}";
+  }
+  ss << "},\"counts\":{";
+  for (size_t c = 0; c < counts_.size(); c++) {
+    if (c > 0) ss << ",";
+    ss << "\"" << counts_[c].name_ << "\":{\"sum\":" << counts_[c].sum_
+        << ",\"max\":" << counts_[c].max_ << "}";
+  }
+  ss << "}}";
+  return ss.str();
+}
+
+void GraphAlignStatsSummary::print(std::ostream & out) {
+  out << "Alignment stages of " << task_num_ << " tasks (ms):" << std::endl;
+  out << std::setw(20) << std::left << "stage" << std::right
+      << std::setw(14) << "wall" << std::setw(14) << "cpu" << std::setw(14) << "max wall" << std::endl;
+  std::streamsize precision = out.precision();
+  out << std::fixed << std::setprecision(1);
+  for (size_t s = 0; s < stages_.size(); s++) {
+    out << std::setw(20) << std::left << stages_[s].name_ << std::right
+        << std::setw(14) << stages_[s].wall_ms_
+        << std::setw(14) << stages_[s].cpu_ms_
+        << std::setw(14) << stages_[s].max_wall_ms_ << std::endl;
+  }
+  out.unsetf(std::ios::floatfield);
+  out.precision(precision);
+}
+
+}  // namespace toppic
@@ -0,0 +1,119 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_STATS_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_STATS_HPP_
+
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace toppic {
+
+struct GraphAlignStageTime {
+  std::string name_;
+  double wall_ms_ = 0;
+  double cpu_ms_ = 0;
+  int call_num_ = 0;
+};
+
+// Times of the stages of one alignment task and sizes of its data
+// structures. Stages and counts are kept in the order they are first
+// added. The stats of a task belong to its GraphAlignRecord and are
+// updated only by the thread aligning the task.
+class GraphAlignStats {
+ public:
+  void addTime(const std::string & name, double wall_ms, double cpu_ms);
+
+  void setCount(const std::string & name, long value);
+
+  const std::vector<GraphAlignStageTime> & getStageTimes() {return stage_times_;}
+
+  const std::vector<std::pair<std::string, long>> & getCounts() {return counts_;}
+
+  // one JSON object without line breaks
+  std::string toJson(int spec_id, double offset);
+
+ private:
+  std::vector<GraphAlignStageTime> stage_times_;
+
+  std::vector<std::pair<std::string, long>> counts_;
+};
+
+// Adds the wall clock time and the CPU time of the calling thread spent
+// in its scope to a stage. Unlike clock(), the CPU time does not include
+// other threads, so it stays correct when spectra are aligned in
+// parallel. Time spent in helper threads started by the stage, such as
+// the row threads of computeRowsT, shows up only in the wall time.
+class GraphAlignTimer {
+ public:
+  GraphAlignTimer(GraphAlignStats & stats, const std::string & name);
+
+  ~GraphAlignTimer();
+
+  // adds the time now instead of at the end of the scope
+  void stop();
+
+  // CPU time of the calling thread in ms, 0 where it is not available
+  static double getThreadCpuMs();
+
+ private:
+  GraphAlignStats & stats_;
+
+  std::string name_;
+
+  std::chrono::steady_clock::time_point wall_start_;
+
+  double cpu_start_;
+
+  bool stopped_ = false;
+};
+
+// Totals of the stats of all tasks of a run.
+class GraphAlignStatsSummary {
+ public:
+  void add(GraphAlignStats & stats);
+
+  std::string toJson();
+
+  void print(std::ostream & out);
+
+ private:
+  struct StageSum {
+    std::string name_;
+    double wall_ms_ = 0;
+    double cpu_ms_ = 0;
+    double max_wall_ms_ = 0;
+    int task_num_ = 0;
+  };
+
+  struct CountSum {
+    std::string name_;
+    long sum_ = 0;
+    long max_ = 0;
+  };
+
+  int task_num_ = 0;
+
+  std::vector<StageSum> stages_;
+
+  std::vector<CountSum> counts_;
+};
+
+}  // namespace toppic
+
+#endif
@@ -0,0 +1,140 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+
+#include "search/graphalign/graph_align_table.hpp"
+
+namespace toppic {
+
+void GraphAlignTable::init(int proteo_ver_num, const std::vector<int> & deltaL,
+                           const std::vector<int> & deltaR, bool store_pres) {
+  store_pres_ = store_pres;
+  spec_ver_num_ = deltaL.size();
+  deltaL_ = deltaL;
+  deltaR_ = deltaR;
+  cell_begin_.assign(proteo_ver_num * spec_ver_num_, -1);
+  T_.clear();
+  pre_begin_.assign(1, 0);
+  pre_end_.clear();
+  pres_.clear();
+  closed_cell_num_ = 0;
+  if (proteo_ver_num > 0 && spec_ver_num_ > 0) {
+    addCell(0, 0);
+    T_[0] = 1;
+  }
+}
+
+int64_t GraphAlignTable::estimateMemBytes(int proteo_ver_num, int spec_ver_num, int64_t cell_num,
+                                          int64_t pre_num, bool store_pres) {
+  int64_t bytes = static_cast<int64_t>(proteo_ver_num) * spec_ver_num * sizeof(int);
+  bytes += cell_num * (sizeof(short) + sizeof(int));
+  if (!store_pres) {
+    bytes += cell_num * sizeof(int);
+  }
+  bytes += pre_num * sizeof(GraphAlignPre);
+  return bytes;
+}
+
+int64_t GraphAlignTable::getMemBytes() {
+  return cell_begin_.capacity() * sizeof(int) + T_.capacity() * sizeof(short)
+      + (pre_begin_.capacity() + pre_end_.capacity()) * sizeof(int)
+      + pres_.capacity() * sizeof(GraphAlignPre);
+}
+
+void GraphAlignTable::addCell(int i, int j) {
+  int & b = cell_begin_[i * spec_ver_num_ + j];
+  if (b >= 0) {
+    return;
+  }
+  b = T_.size();
+  T_.resize(b + getKNum(j), -1);
+  if (store_pres_) {
+    pre_begin_.resize(T_.size() + 1, 0);
+  } else {
+    pre_begin_.resize(T_.size(), 0);
+    pre_end_.resize(T_.size(), -1);
+  }
+}
+
+void GraphAlignCellPres::add(int k, unsigned short i_pre, unsigned short j_pre, short k_value,
+                             unsigned int exact_mass, ModListId mod_list_id) {
+  GraphAlignPre pre;
+  pre.i_pre_ = i_pre;
+  pre.j_pre_ = j_pre;
+  pre.k_value_ = k_value;
+  pre.exact_mass_ = exact_mass;
+  pre.mod_list_id_ = mod_list_id;
+  k_vec_.push_back(k);
+  pres_.push_back(pre);
+}
+
+void GraphAlignTable::closeCell(int i, int j, GraphAlignCellPres & cell_pres) {
+  int cell_begin = cell_begin_[i * spec_ver_num_ + j];
+  if (cell_begin < 0 || !store_pres_) {
+    cell_pres.clear();
+    return;
+  }
+  int k_num = getKNum(j);
+  // cells before (i, j) that were never closed have no predecessors
+  while (closed_cell_num_ < cell_begin) {
+    closed_cell_num_++;
+    pre_begin_[closed_cell_num_] = pres_.size();
+  }
+  // stable counting sort of the predecessors of (i, j) by k
+  const std::vector<int> & k_vec = cell_pres.k_vec_;
+  k_count_.assign(k_num + 1, 0);
+  for (size_t p = 0; p < k_vec.size(); p++) {
+    k_count_[k_vec[p] + 1]++;
+  }
+  int base = pres_.size();
+  for (int k = 0; k < k_num; k++) {
+    k_count_[k + 1] += k_count_[k];
+    pre_begin_[cell_begin + k + 1] = base + k_count_[k + 1];
+  }
+  pres_.resize(base + cell_pres.pres_.size());
+  for (size_t p = 0; p < k_vec.size(); p++) {
+    pres_[base + k_count_[k_vec[p]]++] = cell_pres.pres_[p];
+  }
+  closed_cell_num_ = cell_begin + k_num;
+  cell_pres.clear();
+}
+
+void GraphAlignTable::loadPres(int i, int j, GraphAlignCellPres & cell_pres) {
+  int cell_begin = cell_begin_[i * spec_ver_num_ + j];
+  int k_num = getKNum(j);
+  const std::vector<int> & k_vec = cell_pres.k_vec_;
+  k_count_.assign(k_num + 1, 0);
+  for (size_t p = 0; p < k_vec.size(); p++) {
+    k_count_[k_vec[p] + 1]++;
+  }
+  int base = pres_.size();
+  for (int k = 0; k < k_num; k++) {
+    pre_begin_[cell_begin + k] = base + k_count_[k];
+    k_count_[k + 1] += k_count_[k];
+    pre_end_[cell_begin + k] = base + k_count_[k + 1];
+  }
+  pres_.resize(base + cell_pres.pres_.size());
+  for (size_t p = 0; p < k_vec.size(); p++) {
+    pres_[base + k_count_[k_vec[p]]++] = cell_pres.pres_[p];
+  }
+  cell_pres.clear();
+}
+
+void GraphAlignTable::resetT(int i, int j) {
+  int cell_begin = cell_begin_[i * spec_ver_num_ + j];
+  std::fill(T_.begin() + cell_begin, T_.begin() + cell_begin + getKNum(j), -1);
+}
+
+}  // namespace toppic
@@ -0,0 +1,174 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_TABLE_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_TABLE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "search/graph/mod_list_pool.hpp"
+
+namespace toppic {
+
+// A predecessor of a cell (i, j, k): the cell (i_pre_, j_pre_, k_pre) with
+// k_pre = k_value_ + deltaL[j_pre_].
+struct GraphAlignPre {
+  unsigned short i_pre_;
+  unsigned short j_pre_;
+  short k_value_;
+  unsigned int exact_mass_;
+  ModListId mod_list_id_;
+};
+
+// The predecessors found for the cells of one (i, j) and their k, before
+// they are appended to the table. computeT_v2 fills one of these per open
+// (i, j), so cells of the same row can be computed by different threads.
+struct GraphAlignCellPres {
+  void add(int k, unsigned short i_pre, unsigned short j_pre, short k_value,
+           unsigned int exact_mass, ModListId mod_list_id);
+
+  void clear() {k_vec_.clear(); pres_.clear();}
+
+  std::vector<int> k_vec_;
+
+  std::vector<GraphAlignPre> pres_;
+};
+
+// The T and E tables of GraphAlignSim::computeT_v2.
+//
+// Only the cells of the origin (0, 0) and of the (i, j) added by addCell()
+// are stored; the others are never reachable, read as -1 and have no
+// predecessors. The deltaL[j] + deltaR[j] + 1 cells of a stored (i, j) start
+// at cell_begin_[i * spec_ver_num_ + j] in one buffer, and -1 there marks an
+// (i, j) without cells. The predecessors of all cells are stored in one
+// array in cell order and pre_begin_ gives the range of each cell. Cells are
+// filled row by row, so the predecessors found for (i, j) are kept in a
+// GraphAlignCellPres until closeCell(i, j) appends them.
+//
+// init() clears the buffers but keeps their memory, so a worker reuses one
+// table for all its spectra.
+//
+// Without store_pres, closeCell() drops the predecessors and only T is
+// kept. The predecessors of the cells of an (i, j) are then recomputed
+// when they are needed and added by loadPres(), in any order, with their
+// ranges in pre_begin_ and pre_end_. This is the low-memory mode used
+// when the predecessors of all cells do not fit in the memory budget.
+class GraphAlignTable {
+ public:
+  GraphAlignTable() {}
+
+  void init(int proteo_ver_num, const std::vector<int> & deltaL,
+            const std::vector<int> & deltaR, bool store_pres = true);
+
+  // Bytes of a table with cell_num cells and pre_num predecessors, used
+  // to check the memory budget before the table is filled.
+  static int64_t estimateMemBytes(int proteo_ver_num, int spec_ver_num, int64_t cell_num,
+                                  int64_t pre_num, bool store_pres);
+
+  // bytes held by the buffers, including the memory kept from earlier
+  // spectra
+  int64_t getMemBytes();
+
+  // Stores the cells of (i, j), all set to -1. (i, j) must be added in
+  // order; adding a stored (i, j) again does nothing.
+  void addCell(int i, int j);
+
+  bool hasCell(int i, int j) {return cell_begin_[i * spec_ver_num_ + j] >= 0;}
+
+  int getKNum(int j) {return deltaL_[j] + deltaR_[j] + 1;}
+
+  short getT(int i, int j, int k) {
+    int b = cell_begin_[i * spec_ver_num_ + j];
+    return b < 0 ? -1 : T_[b + k];
+  }
+
+  // Index of the cell (i, j, k) in the cell buffer, -1 if (i, j) is not
+  // stored. Stored cells have indices 0 .. getCellNum() - 1.
+  int getCellIndex(int i, int j, int k) {
+    int b = cell_begin_[i * spec_ver_num_ + j];
+    return b < 0 ? -1 : b + k;
+  }
+
+  int getCellNum() {return T_.size();}
+
+  // (i, j) must be stored
+  void setT(int i, int j, int k, short t) {T_[cell_begin_[i * spec_ver_num_ + j] + k] = t;}
+
+  // Appends the predecessors of the cells of (i, j) to the edge array
+  // and clears cell_pres. Cells must be closed in (i, j) order.
+  void closeCell(int i, int j, GraphAlignCellPres & cell_pres);
+
+  int getPreBegin(int i, int j, int k) {
+    int b = cell_begin_[i * spec_ver_num_ + j];
+    return b < 0 ? 0 : pre_begin_[b + k];
+  }
+
+  int getPreEnd(int i, int j, int k) {
+    int b = cell_begin_[i * spec_ver_num_ + j];
+    if (b < 0) {
+      return 0;
+    }
+    return store_pres_ ? pre_begin_[b + k + 1] : pre_end_[b + k];
+  }
+
+  const GraphAlignPre & getPre(int p) {return pres_[p];}
+
+  bool isStorePres() {return store_pres_;}
+
+  // whether the predecessors of the cells of (i, j) can be read
+  bool hasPres(int i, int j) {
+    int b = cell_begin_[i * spec_ver_num_ + j];
+    return store_pres_ || b < 0 || pre_end_[b] >= 0;
+  }
+
+  // Adds the predecessors of the cells of (i, j) in the low-memory mode
+  // and clears cell_pres.
+  void loadPres(int i, int j, GraphAlignCellPres & cell_pres);
+
+  // sets the T of the cells of (i, j) to -1 before they are recomputed
+  void resetT(int i, int j);
+
+ private:
+  int spec_ver_num_ = 0;
+
+  std::vector<int> deltaL_;
+
+  std::vector<int> deltaR_;
+
+  std::vector<int> cell_begin_;
+
+  std::vector<short> T_;
+
+  std::vector<int> pre_begin_;
+
+  // end of the predecessors of each cell in the low-memory mode, -1 for
+  // cells that are not loaded
+  std::vector<int> pre_end_;
+
+  std::vector<GraphAlignPre> pres_;
+
+  bool store_pres_ = true;
+
+  int closed_cell_num_ = 0;
+
+  std::vector<int> k_count_;
+};
+
+typedef std::shared_ptr<GraphAlignTable> GraphAlignTablePtr;
+
+}  // namespace toppic
+
+#endif
@@ -0,0 +1,103 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "search/graphalign/graph_align_task_queue.hpp"
+
+namespace toppic {
+
+GraphAlignTaskQueue::GraphAlignTaskQueue(int worker_num, int capacity):
+    capacity_(capacity),
+    size_(0) {
+      if (worker_num < 1) worker_num = 1;
+      if (capacity_ < 1) capacity_ = 1;
+      for (int i = 0; i < worker_num; i++) {
+        deques_.push_back(std::make_shared<WorkerDeque>());
+      }
+    }
+
+void GraphAlignTaskQueue::push(GraphAlignTaskPtr task_ptr) {
+  int target;
+  {
+    boost::unique_lock<boost::mutex> lock(state_mutex_);
+    not_full_.wait(lock, [this]{ return size_ < capacity_; });
+    target = next_worker_;
+    next_worker_ = (next_worker_ + 1) % deques_.size();
+  }
+  {
+    boost::unique_lock<boost::mutex> lock(deques_[target]->mutex_);
+    deques_[target]->tasks_.push_back(task_ptr);
+    size_++;
+  }
+  // Taking the state mutex before notifying avoids a lost wake up of a
+  // worker that has checked size_ but not started waiting yet.
+  {
+    boost::unique_lock<boost::mutex> lock(state_mutex_);
+  }
+  not_empty_.notify_one();
+}
+
+void GraphAlignTaskQueue::close() {
+  {
+    boost::unique_lock<boost::mutex> lock(state_mutex_);
+    closed_ = true;
+  }
+  not_empty_.notify_all();
+}
+
+GraphAlignTaskPtr GraphAlignTaskQueue::tryPop(int worker_idx) {
+  int deque_num = deques_.size();
+  // own deque first, oldest task first
+  {
+    WorkerDeque & own = *deques_[worker_idx % deque_num];
+    boost::unique_lock<boost::mutex> lock(own.mutex_);
+    if (!own.tasks_.empty()) {
+      GraphAlignTaskPtr task_ptr = own.tasks_.front();
+      own.tasks_.pop_front();
+      size_--;
+      return task_ptr;
+    }
+  }
+  // steal from the back of the other deques
+  for (int i = 1; i < deque_num; i++) {
+    WorkerDeque & victim = *deques_[(worker_idx + i) % deque_num];
+    boost::unique_lock<boost::mutex> lock(victim.mutex_);
+    if (!victim.tasks_.empty()) {
+      GraphAlignTaskPtr task_ptr = victim.tasks_.back();
+      victim.tasks_.pop_back();
+      size_--;
+      return task_ptr;
+    }
+  }
+  return nullptr;
+}
+
+GraphAlignTaskPtr GraphAlignTaskQueue::pop(int worker_idx) {
+  while (true) {
+    GraphAlignTaskPtr task_ptr = tryPop(worker_idx);
+    if (task_ptr != nullptr) {
+      {
+        boost::unique_lock<boost::mutex> lock(state_mutex_);
+      }
+      not_full_.notify_one();
+      return task_ptr;
+    }
+    boost::unique_lock<boost::mutex> lock(state_mutex_);
+    not_empty_.wait(lock, [this]{ return size_ > 0 || closed_; });
+    if (closed_ && size_ == 0) {
+      return nullptr;
+    }
+  }
+}
+
+}  // namespace toppic
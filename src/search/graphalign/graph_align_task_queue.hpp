@@ -0,0 +1,123 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_TASK_QUEUE_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_ALIGN_TASK_QUEUE_HPP_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "ms/spec/spectrum_set.hpp"
+
+namespace toppic {
+
+// One unit of work: a spectrum and one of its candidate reference
+// peptides, aligned with each of the precursor mass offsets. The records
+// of the offsets are numbered from task_idx_ in the input order and are
+// used to write the results back in spectrum order.
+class GraphAlignTask {
+ public:
+  GraphAlignTask(int task_idx, SpectrumSetPtr spec_set_ptr,
+                 const std::vector<double> & prec_errors,
+                 const std::string & ref_raw_seq, int cand_idx, int cand_num):
+      task_idx_(task_idx),
+      spec_set_ptr_(spec_set_ptr),
+      prec_errors_(prec_errors),
+      ref_raw_seq_(ref_raw_seq),
+      cand_idx_(cand_idx),
+      cand_num_(cand_num) {}
+
+  int getTaskIdx() {return task_idx_;}
+
+  SpectrumSetPtr getSpectrumSetPtr() {return spec_set_ptr_;}
+
+  const std::vector<double> & getPrecErrors() {return prec_errors_;}
+
+  const std::string & getRefRawSeq() {return ref_raw_seq_;}
+
+  int getCandIdx() {return cand_idx_;}
+
+  int getCandNum() {return cand_num_;}
+
+ private:
+  int task_idx_;
+
+  SpectrumSetPtr spec_set_ptr_;
+
+  std::vector<double> prec_errors_;
+
+  std::string ref_raw_seq_;
+
+  // position of the peptide in the candidates of the spectrum
+  int cand_idx_;
+
+  int cand_num_;
+};
+
+typedef std::shared_ptr<GraphAlignTask> GraphAlignTaskPtr;
+
+// A bounded work-stealing queue. Each worker owns a deque; the producer
+// distributes tasks round robin, a worker takes tasks from the front of
+// its own deque and steals from the back of the others when it runs dry.
+class GraphAlignTaskQueue {
+ public:
+  GraphAlignTaskQueue(int worker_num, int capacity);
+
+  // Blocks while the queue holds capacity tasks.
+  void push(GraphAlignTaskPtr task_ptr);
+
+  // No more tasks will be pushed.
+  void close();
+
+  // Blocks until a task is available. Returns nullptr when the queue
+  // is closed and all tasks have been taken.
+  GraphAlignTaskPtr pop(int worker_idx);
+
+ private:
+  struct WorkerDeque {
+    boost::mutex mutex_;
+    std::deque<GraphAlignTaskPtr> tasks_;
+  };
+
+  GraphAlignTaskPtr tryPop(int worker_idx);
+
+  std::vector<std::shared_ptr<WorkerDeque>> deques_;
+
+  int capacity_;
+
+  int next_worker_ = 0;
+
+  std::atomic<int> size_;
+
+  bool closed_ = false;
+
+  boost::mutex state_mutex_;
+
+  boost::condition_variable not_empty_;
+
+  boost::condition_variable not_full_;
+};
+
+typedef std::shared_ptr<GraphAlignTaskQueue> GraphAlignTaskQueuePtr;
+
+}  // namespace toppic
+
+#endif
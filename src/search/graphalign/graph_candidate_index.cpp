@@ -0,0 +1,82 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+
+#include "common/util/logger.hpp"
+#include "common/util/str_util.hpp"
+#include "search/graphalign/graph_candidate_index.hpp"
+
+namespace toppic {
+
+GraphCandidateIndex::GraphCandidateIndex(const std::string & file_name) {
+  std::ifstream f(file_name);
+  if (!f.is_open()) {
+    LOG_WARN("Reference peptide file " << file_name << " cannot be opened.");
+    return;
+  }
+  std::string line;
+  int line_num = 0;
+  while (getline(f, line)) {
+    line_num++;
+    if (line.empty()) continue;
+    std::vector<std::string> l = str_util::split(line, "\t");
+    // a header line or a line without a tab has no spectrum id
+    int sp_id = -1;
+    bool valid_id = false;
+    if (l.size() >= 2) {
+      str_util::trim(l[0]);
+      try {
+        size_t id_len = 0;
+        sp_id = std::stoi(l[0], &id_len);
+        valid_id = (id_len == l[0].length());
+      }
+      catch (std::exception & e) {
+        valid_id = false;
+      }
+    }
+    if (!valid_id) {
+      LOG_WARN("Reference peptide file " << file_name << " line " << line_num
+               << " has no valid spectrum id.");
+      continue;
+    }
+    std::string pep = l[1];
+    // removes the '\r' of files with Windows line ends
+    str_util::trim(pep);
+    if (pep.empty()) {
+      LOG_WARN("Reference peptide file " << file_name << " line " << line_num
+               << " has no peptide.");
+      continue;
+    }
+    std::vector<std::string> & cands = candidates_[sp_id];
+    if (std::find(cands.begin(), cands.end(), pep) == cands.end()) {
+      cands.push_back(pep);
+      candidate_num_++;
+    }
+  }
+  f.close();
+}
+
+const std::vector<std::string> & GraphCandidateIndex::getCandidates(int spec_id) const {
+  std::unordered_map<int, std::vector<std::string>>::const_iterator it = candidates_.find(spec_id);
+  if (it == candidates_.end()) {
+    return empty_;
+  }
+  return it->second;
+}
+
+}  // namespace toppic
@@ -0,0 +1,54 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_CANDIDATE_INDEX_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_CANDIDATE_INDEX_HPP_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace toppic {
+
+// Reference peptides of the spectra, read from a file with a spectrum id
+// and a peptide separated by a tab on each line. A spectrum may be listed
+// on several lines and its candidates keep the order of the file. The
+// index is read once and is not changed afterwards, so it is shared by
+// all workers without locking.
+class GraphCandidateIndex {
+ public:
+  explicit GraphCandidateIndex(const std::string & file_name);
+
+  // Returns an empty vector if the spectrum has no candidates.
+  const std::vector<std::string> & getCandidates(int spec_id) const;
+
+  int getSpecNum() const {return candidates_.size();}
+
+  int getCandidateNum() const {return candidate_num_;}
+
+ private:
+  std::unordered_map<int, std::vector<std::string>> candidates_;
+
+  int candidate_num_ = 0;
+
+  std::vector<std::string> empty_;
+};
+
+typedef std::shared_ptr<const GraphCandidateIndex> GraphCandidateIndexPtr;
+
+}  // namespace toppic
+
+#endif
@@ -0,0 +1,105 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "search/graphalign/graph_cons_pair_table.hpp"
+
+namespace toppic {
+
+void GraphConsPairTable::init(int proteo_ver_num, int spec_ver_num) {
+  spec_ver_num_ = spec_ver_num;
+  cell_last_group_.assign(proteo_ver_num * spec_ver_num, -1);
+  group_cell_.clear();
+  group_mass_.clear();
+  pair_group_.clear();
+  pairs_.clear();
+  pair_keys_.clear();
+  cell_group_begin_.clear();
+  group_pair_begin_.clear();
+}
+
+void GraphConsPairTable::addPair(int pr_v2, int sp_v2, unsigned int mass,
+                                 unsigned short pr_v1, unsigned short sp_v1,
+                                 ModListId mod_list_id) {
+  int cell = pr_v2 * spec_ver_num_ + sp_v2;
+  int group = cell_last_group_[cell];
+  if (group < 0 || group_mass_[group] != mass) {
+    group = group_mass_.size();
+    group_cell_.push_back(cell);
+    group_mass_.push_back(mass);
+    cell_last_group_[cell] = group;
+  }
+  uint64_t key = (static_cast<uint64_t>(group) << 32)
+      | (static_cast<uint64_t>(pr_v1) << 16) | sp_v1;
+  if (!pair_keys_.insert(key).second) {
+    return;
+  }
+  pair_group_.push_back(group);
+  pairs_.push_back(std::make_pair(std::make_pair(pr_v1, sp_v1), mod_list_id));
+}
+
+void GraphConsPairTable::build() {
+  int cell_num = cell_last_group_.size();
+  int group_num = group_mass_.size();
+
+  // sort the groups by cell, keeping the creation order within a cell
+  cell_group_begin_.assign(cell_num + 1, 0);
+  for (int g = 0; g < group_num; g++) {
+    cell_group_begin_[group_cell_[g] + 1]++;
+  }
+  for (int c = 0; c < cell_num; c++) {
+    cell_group_begin_[c + 1] += cell_group_begin_[c];
+  }
+  std::vector<int> next_group(cell_group_begin_.begin(), cell_group_begin_.end() - 1);
+  std::vector<int> group_order(group_num);
+  std::vector<unsigned int> sorted_mass(group_num);
+  for (int g = 0; g < group_num; g++) {
+    int pos = next_group[group_cell_[g]]++;
+    group_order[g] = pos;
+    sorted_mass[pos] = group_mass_[g];
+  }
+
+  // sort the pairs by group, reversing the order within a group
+  group_pair_begin_.assign(group_num + 1, 0);
+  for (size_t p = 0; p < pair_group_.size(); p++) {
+    group_pair_begin_[group_order[pair_group_[p]] + 1]++;
+  }
+  for (int g = 0; g < group_num; g++) {
+    group_pair_begin_[g + 1] += group_pair_begin_[g];
+  }
+  std::vector<int> next_pair(group_pair_begin_.begin() + 1, group_pair_begin_.end());
+  std::vector<GraphConsPair> sorted_pairs(pairs_.size());
+  for (size_t p = 0; p < pair_group_.size(); p++) {
+    sorted_pairs[--next_pair[group_order[pair_group_[p]]]] = pairs_[p];
+  }
+
+  group_mass_.swap(sorted_mass);
+  pairs_.swap(sorted_pairs);
+  std::vector<int>().swap(cell_last_group_);
+  std::vector<int>().swap(group_cell_);
+  std::vector<int>().swap(pair_group_);
+  std::unordered_set<uint64_t>().swap(pair_keys_);
+}
+
+void GraphConsPairTable::clear() {
+  std::vector<int>().swap(cell_last_group_);
+  std::vector<int>().swap(group_cell_);
+  std::vector<unsigned int>().swap(group_mass_);
+  std::vector<int>().swap(pair_group_);
+  std::vector<GraphConsPair>().swap(pairs_);
+  std::unordered_set<uint64_t>().swap(pair_keys_);
+  std::vector<int>().swap(cell_group_begin_);
+  std::vector<int>().swap(group_pair_begin_);
+}
+
+}  // namespace toppic
@@ -0,0 +1,97 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_CONS_PAIR_TABLE_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_CONS_PAIR_TABLE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "search/graph/mod_list_pool.hpp"
+
+namespace toppic {
+
+// ((pr_v1, sp_v1), mod list id) of a consistent pair ending at (pr_v2, sp_v2)
+typedef std::pair<std::pair<unsigned short, unsigned short>, ModListId> GraphConsPair;
+
+// Consistent pairs of GraphAlignSim grouped by the end cell (pr_v2, sp_v2)
+// and the protein mass.
+//
+// While the pairs are added, a pair with the same mass as the last group
+// of its cell joins that group, otherwise it starts a new group. Pairs are
+// appended to one array and duplicates (pr_v1, sp_v1) within a group are
+// found with a hash set. build() then sorts the groups by cell and the
+// pairs by group into flat arrays. The pairs of a group are emitted in the
+// reverse order of insertion, the order computeT_v2 expects.
+class GraphConsPairTable {
+ public:
+  GraphConsPairTable() {}
+
+  void init(int proteo_ver_num, int spec_ver_num);
+
+  void addPair(int pr_v2, int sp_v2, unsigned int mass,
+               unsigned short pr_v1, unsigned short sp_v1, ModListId mod_list_id);
+
+  void build();
+
+  // releases all memory
+  void clear();
+
+  int getGroupBegin(int i, int j) {return cell_group_begin_[i * spec_ver_num_ + j];}
+
+  int getGroupEnd(int i, int j) {return cell_group_begin_[i * spec_ver_num_ + j + 1];}
+
+  unsigned int getGroupMass(int g) {return group_mass_[g];}
+
+  const GraphConsPair * getGroupPairs(int g) {return pairs_.data() + group_pair_begin_[g];}
+
+  int getGroupPairNum(int g) {return group_pair_begin_[g + 1] - group_pair_begin_[g];}
+
+  int getPairNum() {return pairs_.size();}
+
+  // bytes held after build()
+  int64_t getMemBytes() {
+    return (cell_group_begin_.capacity() + group_pair_begin_.capacity()) * sizeof(int)
+        + group_mass_.capacity() * sizeof(unsigned int)
+        + pairs_.capacity() * sizeof(GraphConsPair);
+  }
+
+ private:
+  int spec_ver_num_ = 0;
+
+  // groups in the order they are created
+  std::vector<int> cell_last_group_;
+  std::vector<int> group_cell_;
+  std::vector<unsigned int> group_mass_;
+
+  // pairs in the order they are added
+  std::vector<int> pair_group_;
+  std::vector<GraphConsPair> pairs_;
+
+  // keys (group, pr_v1, sp_v1) of the added pairs
+  std::unordered_set<uint64_t> pair_keys_;
+
+  // flat result
+  std::vector<int> cell_group_begin_;
+  std::vector<int> group_pair_begin_;
+};
+
+typedef std::shared_ptr<GraphConsPairTable> GraphConsPairTablePtr;
+
+}  // namespace toppic
+
+#endif
@@ -0,0 +1,91 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_PAIR_TABLE_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_PAIR_TABLE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace toppic {
+
+// Vertex pairs of the GraphAlignGraph reached by ConstructQ2. Each pair
+// gets a dense id in the order it is first reached, so the two-path DP
+// tables are flat arrays of size getPairNum() instead of V x V tables.
+// The successor pairs of a pair are stored in one flat array.
+class GraphPairTable {
+ public:
+  explicit GraphPairTable(int ver_num): ver_num_(ver_num) {}
+
+  int getPairNum() {return pairs_.size();}
+
+  // Returns the id of the pair, a new id is assigned to a new pair.
+  int addPair(int v1, int v2) {
+    int64_t key = static_cast<int64_t>(v1) * ver_num_ + v2;
+    std::unordered_map<int64_t, int>::iterator it = id_map_.find(key);
+    if (it != id_map_.end()) {
+      return it->second;
+    }
+    int id = pairs_.size();
+    id_map_[key] = id;
+    pairs_.push_back(std::make_pair(v1, v2));
+    child_begin_.push_back(-1);
+    child_end_.push_back(-1);
+    return id;
+  }
+
+  const std::pair<int, int> & getPair(int id) {return pairs_[id];}
+
+  bool isExpanded(int id) {return child_begin_[id] >= 0;}
+
+  void setChildren(int id, const std::vector<int> & child_ids) {
+    child_begin_[id] = children_.size();
+    children_.insert(children_.end(), child_ids.begin(), child_ids.end());
+    child_end_[id] = children_.size();
+  }
+
+  int getChildBegin(int id) {return child_begin_[id];}
+
+  int getChildEnd(int id) {return child_end_[id];}
+
+  int getChildNum(int id) {return child_end_[id] - child_begin_[id];}
+
+  int getChild(int c) {return children_[c];}
+
+  // size of the flat child array
+  int getTotalChildNum() {return children_.size();}
+
+ private:
+  int64_t ver_num_;
+
+  std::unordered_map<int64_t, int> id_map_;
+
+  std::vector<std::pair<int, int>> pairs_;
+
+  std::vector<int> child_begin_;
+
+  std::vector<int> child_end_;
+
+  std::vector<int> children_;
+};
+
+typedef std::shared_ptr<GraphPairTable> GraphPairTablePtr;
+
+}  // namespace toppic
+
+#endif
@@ -0,0 +1,234 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/util/logger.hpp"
+#include "search/graphalign/graph_two_path_batch.hpp"
+
+namespace toppic {
+
+GraphTwoPathBatch::GraphTwoPathBatch(GraphAlignGraph & graph,
+                                     const std::vector<int> & Q2,
+                                     GraphPairTable & pair_table,
+                                     const std::vector<double> & intens,
+                                     int last_i, int lane_num):
+    lane_num_(std::max(lane_num, 1)) {
+      pair_num_ = pair_table.getPairNum();
+      std::vector<char> visited(pair_num_, false);
+      std::vector<char> cut(pair_num_, false);
+      child_begin_.push_back(0);
+      // pairs are visited as in FindTwoPath: from the end of Q2, which
+      // lists each pair once in topological order
+      for (int n = Q2.size() - 1; n >= 0; n--) {
+        int slot = Q2[n];
+        visited[slot] = true;
+        if (n == 0) {
+          root_slot_ = slot;
+        }
+
+        const std::pair<int, int> & node_pair = pair_table.getPair(slot);
+        int i1 = graph.getVertex(node_pair.first).i_;
+        int i2 = graph.getVertex(node_pair.second).i_;
+        int j1 = graph.getVertex(node_pair.first).j_;
+        int j2 = graph.getVertex(node_pair.second).j_;
+        if (i1 == last_i && i2 == last_i) {
+          end_slots_.push_back(slot);
+          continue;
+        }
+        int child_begin = pair_table.getChildBegin(slot);
+        int child_end = pair_table.getChildEnd(slot);
+        if (child_begin == child_end) {
+          cut[slot] = true;
+          if (n == 0) {
+            root_cut_ = true;
+            root_cut_value_ = -1;
+          }
+          continue;
+        }
+
+        // p and q terms of the node
+        double pi = 0, pa = 0, pb = 0, ps = 0;
+        double qi = 0, qa = 0, qb = 0, qs = 0;
+        if (n != 0) {
+          if (i1 == last_i) {
+            if (j1 != j2) {
+              pi = intens[j2]; pb = 1; ps = 1;
+            } else {
+              pi = intens[j1]; pa = 1; ps = -1;
+              qi = intens[j1]; qa = 1; qb = 1; qs = 1;
+            }
+          } else if (i2 == last_i) {
+            if (j1 != j2) {
+              pi = intens[j1]; pa = 1; ps = 1;
+            } else {
+              pi = intens[j2]; pb = 1; ps = -1;
+              qi = intens[j1]; qa = 1; qb = 1; qs = 1;
+            }
+          } else {
+            if (j1 == j2) {
+              pi = intens[j1]; pa = 1; pb = 1; ps = 1;
+            } else if (j1 < j2) {
+              pi = intens[j1]; pa = 1; ps = 1;
+            } else {
+              pi = intens[j2]; pb = 1; ps = 1;
+            }
+          }
+        }
+
+        bool node_cut = true;
+        bool force_first = false;
+        int begin = child_slot_.size();
+        for (int c = child_begin; c < child_end; c++) {
+          int child = pair_table.getChild(c);
+          if (!visited[child]) {
+            LOG_ERROR("Two path batch: child pair is not computed before its parent!");
+            exit(EXIT_FAILURE);
+          }
+          if (cut[child]) {
+            continue;
+          }
+          node_cut = false;
+          if (c == child_begin) {
+            force_first = true;
+          }
+          double w1 = 0, w2 = 0;
+          if (n != 0) {
+            const std::pair<int, int> & child_pair = pair_table.getPair(child);
+            int cur_i1 = graph.getVertex(child_pair.first).i_;
+            int cur_i2 = graph.getVertex(child_pair.second).i_;
+            if (i1 == last_i) {
+              w2 = cur_i2 - i2 - 1;
+            } else if (i2 == last_i) {
+              w1 = cur_i1 - i1 - 1;
+            } else if (j1 == j2) {
+              w1 = cur_i1 - i1 - 1;
+              w2 = cur_i2 - i2 - 1;
+            } else if (j1 < j2) {
+              w1 = cur_i1 - i1 - 1;
+            } else {
+              w2 = cur_i2 - i2 - 1;
+            }
+          }
+          child_slot_.push_back(child);
+          child_w1_.push_back(w1);
+          child_w2_.push_back(w2);
+        }
+        if (node_cut) {
+          cut[slot] = true;
+          child_slot_.resize(begin);
+          child_w1_.resize(begin);
+          child_w2_.resize(begin);
+          if (n == 0) {
+            root_cut_ = true;
+            root_cut_value_ = 999999999999;
+          }
+          continue;
+        }
+        node_slot_.push_back(slot);
+        child_begin_.push_back(child_slot_.size());
+        force_first_.push_back(force_first);
+        p_inten_.push_back(pi); p_a_.push_back(pa); p_b_.push_back(pb); p_s_.push_back(ps);
+        q_inten_.push_back(qi); q_a_.push_back(qa); q_b_.push_back(qb); q_s_.push_back(qs);
+      }
+    }
+
+int64_t GraphTwoPathBatch::estimateMemBytes(int64_t pair_num, int64_t child_num, int lane_num) {
+  // per pair: the pair, its child range and its hash entry in
+  // GraphPairTable, the state, Q2 and stack of ConstructQ2, D, B and the
+  // cut flag of FindTwoPath, and the node arrays of the batch
+  const int64_t pair_bytes = 160;
+  // per child: GraphPairTable and the child slot and weights of the batch
+  const int64_t child_bytes = 24;
+  return pair_num * (pair_bytes + static_cast<int64_t>(lane_num) * sizeof(double))
+      + child_num * child_bytes;
+}
+
+int GraphTwoPathBatch::getLaneNum(int64_t budget_bytes, int64_t pair_num, int64_t child_num,
+                                  int max_lane_num) {
+  int64_t fixed_bytes = estimateMemBytes(pair_num, child_num, 0);
+  if (pair_num == 0 || budget_bytes <= fixed_bytes) {
+    return 1;
+  }
+  int64_t lane_num = (budget_bytes - fixed_bytes) / (pair_num * static_cast<int64_t>(sizeof(double)));
+  return static_cast<int>(std::max<int64_t>(1, std::min<int64_t>(lane_num, max_lane_num)));
+}
+
+void GraphTwoPathBatch::computeTile(const double * q1, const double * q2, double * result) {
+  const int L = lane_num_;
+  if (root_cut_) {
+    for (int l = 0; l < L; l++) {
+      result[l] = root_cut_value_;
+    }
+    return;
+  }
+  D_.resize(static_cast<size_t>(pair_num_) * L);
+  for (size_t e = 0; e < end_slots_.size(); e++) {
+    double * d = &D_[static_cast<size_t>(end_slots_[e]) * L];
+    std::fill(d, d + L, 0.0);
+  }
+  std::vector<double> p_term(L), q_term(L), min_error(L);
+  double * p = p_term.data();
+  double * q = q_term.data();
+  double * m = min_error.data();
+  for (size_t n = 0; n < node_slot_.size(); n++) {
+    const double pi = p_inten_[n], pa = p_a_[n], pb = p_b_[n], ps = p_s_[n];
+    const double qi = q_inten_[n], qa = q_a_[n], qb = q_b_[n], qs = q_s_[n];
+    for (int l = 0; l < L; l++) {
+      p[l] = ps * std::fabs(pi - pa * q1[l] - pb * q2[l]);
+      q[l] = qs * std::fabs(qi - qa * q1[l] - qb * q2[l]);
+      m[l] = 999999999999;
+    }
+    for (int c = child_begin_[n]; c < child_begin_[n + 1]; c++) {
+      const double * d = &D_[static_cast<size_t>(child_slot_[c]) * L];
+      const double w1 = child_w1_[c];
+      const double w2 = child_w2_[c];
+      if (c == child_begin_[n] && force_first_[n]) {
+        for (int l = 0; l < L; l++) {
+          m[l] = d[l] + p[l] + q[l] + q1[l] * w1 + q2[l] * w2;
+        }
+      } else {
+        for (int l = 0; l < L; l++) {
+          double v = d[l] + p[l] + q[l] + q1[l] * w1 + q2[l] * w2;
+          m[l] = v < m[l] ? v : m[l];
+        }
+      }
+    }
+    std::copy(m, m + L, &D_[static_cast<size_t>(node_slot_[n]) * L]);
+  }
+  std::copy(&D_[static_cast<size_t>(root_slot_) * L],
+            &D_[static_cast<size_t>(root_slot_) * L] + L, result);
+}
+
+std::vector<double> GraphTwoPathBatch::compute(const std::vector<double> & q1_vec,
+                                               const std::vector<double> & q2_vec) {
+  const int L = lane_num_;
+  std::vector<double> result(q1_vec.size());
+  std::vector<double> q1(L), q2(L), tile_result(L);
+  for (size_t start = 0; start < q1_vec.size(); start += L) {
+    size_t len = std::min(q1_vec.size() - start, static_cast<size_t>(L));
+    // a partial tile is padded with its last candidate
+    for (int l = 0; l < L; l++) {
+      size_t k = start + std::min(static_cast<size_t>(l), len - 1);
+      q1[l] = q1_vec[k];
+      q2[l] = q2_vec[k];
+    }
+    computeTile(q1.data(), q2.data(), tile_result.data());
+    std::copy(tile_result.begin(), tile_result.begin() + len, result.begin() + start);
+  }
+  return result;
+}
+
+}  // namespace toppic
@@ -0,0 +1,102 @@
+//Copyright (c) 2014 - 2019, The Trustees of Indiana University.
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+
+#ifndef TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_TWO_PATH_BATCH_HPP_
+#define TOPPIC_SEARCH_GRAPH_ALIGN_GRAPH_TWO_PATH_BATCH_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "search/graphalign/graph_align_graph.hpp"
+#include "search/graphalign/graph_pair_table.hpp"
+
+namespace toppic {
+
+// Evaluates the two-path error D[0][0] of GraphAlignSim::FindTwoPath for
+// many (q1, q2) candidates with one reverse traversal of Q2.
+//
+// The traversal order, the cut pairs and the children of each pair do
+// not depend on q1 and q2, so they are compiled once into flat arrays.
+// A batch of candidates is then carried through the traversal as lanes:
+// the DP value of a pair is stored as lane_num consecutive doubles and
+// the inner loops run over the lanes, which the compiler vectorizes.
+// The arithmetic is done in the same order as in FindTwoPath, so each
+// lane gives exactly the scalar result.
+class GraphTwoPathBatch {
+ public:
+  GraphTwoPathBatch(GraphAlignGraph & graph,
+                    const std::vector<int> & Q2,
+                    GraphPairTable & pair_table,
+                    const std::vector<double> & intens,
+                    int last_i, int lane_num);
+
+  std::vector<double> compute(const std::vector<double> & q1_vec,
+                              const std::vector<double> & q2_vec);
+
+  int getPairNum() {return pair_num_;}
+
+  // Bytes used by the quantification of pair_num pairs with child_num
+  // children: the pair table, the tables of FindTwoPath and a batch of
+  // lane_num lanes.
+  static int64_t estimateMemBytes(int64_t pair_num, int64_t child_num, int lane_num);
+
+  // The largest lane number up to max_lane_num whose batch fits in
+  // budget_bytes, at least 1. Fewer lanes only mean more traversals of
+  // Q2 for the same candidates, the results do not change.
+  static int getLaneNum(int64_t budget_bytes, int64_t pair_num, int64_t child_num,
+                        int max_lane_num);
+
+ private:
+  void computeTile(const double * q1, const double * q2, double * result);
+
+  int lane_num_;
+
+  int pair_num_ = 0;
+
+  // slots are the pair ids of pair_table
+  // the slot of the root pair (v_0, v_0)
+  int root_slot_ = -1;
+
+  // value of the root when it is cut
+  double root_cut_value_ = 0;
+
+  bool root_cut_ = false;
+
+  // slots of the pairs where both vertices are end nodes
+  std::vector<int> end_slots_;
+
+  // pairs that are neither end pairs nor cut, in traversal order
+  std::vector<int> node_slot_;
+  std::vector<int> child_begin_;
+  std::vector<char> force_first_;
+
+  // node error terms: s * |inten - a * q1 - b * q2|
+  std::vector<double> p_inten_, p_a_, p_b_, p_s_;
+  std::vector<double> q_inten_, q_a_, q_b_, q_s_;
+
+  // children that are not cut
+  std::vector<int> child_slot_;
+  std::vector<double> child_w1_;
+  std::vector<double> child_w2_;
+
+  std::vector<double> D_;
+};
+
+typedef std::shared_ptr<GraphTwoPathBatch> GraphTwoPathBatchPtr;
+
+}  // namespace toppic
+
+#endif